@@ -5,6 +5,8 @@
 
 #include "borg1.h"
 
+#include <time.h>
+
 /*
  * This file contains various low level variables and routines.
  */
@@ -40,6 +42,7 @@ bool borg_worships_ac;
 bool borg_worships_gold;
 bool borg_plays_risky;
 bool borg_slow_optimizehome;
+int borg_home_budget;	/* msec allowed to the slow home optimizer */
 bool borg_scums_uniques;
 bool borg_kills_uniques;
 int borg_chest_fail_tolerance;
@@ -50,8 +53,11 @@ bool borg_self_scum; 	/* borg scums on his own */
 bool borg_lunal_mode;  /* see borg.txt */
 bool borg_self_lunal;  /* borg allowed to do this himself */
 bool borg_verbose;
+int borg_note_mask = BORG_NOTE_ALL;	/* notes shown, see borg.txt */
 bool borg_munchkin_start;
 bool borg_munchkin_mode;
+bool borg_turbo;		/* skip the display, see borg.txt */
+int borg_turbo_snapshot;	/* game turns between screen snapshots */
 
 
 /* HACK... this should really be a parm into borg_prepared */
@@ -336,6 +342,8 @@ u32b borg_rand_value;       /* Save system setting */
 
 u32b borg_rand_local;       /* Save personal setting */
 
+byte borg_journal;          /* Recording or replaying a session */
+
 
 /*
  * Hack -- Time variables
@@ -986,6 +994,13 @@ s16b borg_kills_summoner;    /* index of a summoner */
 s16b borg_kills_nxt;
 
 borg_kill *borg_kills;
+borg_kill_spell *borg_kill_spells;
+
+byte borg_kills_live[256];
+s16b borg_kills_live_n;
+
+borg_cells borg_take_cells;
+borg_cells borg_kill_cells;
 
 
 /* a 3 state boolean */
@@ -1136,6 +1151,18 @@ borg_data *borg_data_icky;  /* Current "icky" flags */
 
 bool borg_danger_wipe = FALSE;  /* Recalculate danger */
 
+u32b borg_flow_epoch = 0;  /* Cached flows older than this are stale */
+
+s32b borg_flow_hits = 0;  /* Flows served from the flow cache */
+
+s32b borg_flow_builds = 0;  /* Flows spread from scratch */
+
+s32b borg_map_cells = 0;  /* Panel grids scanned by borg_update_map() */
+
+s32b borg_map_examined = 0;  /* Panel grids worked through */
+
+s32b borg_map_changed = 0;  /* Panel grids with a new glyph */
+
 bool borg_do_update_view = FALSE;  /* Recalculate view */
 
 bool borg_do_update_LIGHT = FALSE;  /* Recalculate lite */
@@ -1517,40 +1544,124 @@ void borg_info(cptr what)
 
 
 /*
- * Memorize a message, Log it, Search it, and Display it in pieces
+ * Notes waiting for the borg message window.  borg_note() only copies
+ * the text here, and borg_note_flush() draws the lot with a single
+ * Term_fresh() per window, once per borg keypress.
  */
-void borg_note(cptr what)
+#define BORG_NOTE_BUF   16384   /* Bytes of queued text */
+#define BORG_NOTE_MAX   256     /* Queued notes */
+
+static char borg_note_buf[BORG_NOTE_BUF];
+static u16b borg_note_pos[BORG_NOTE_MAX];
+static int borg_note_len = 0;
+static int borg_note_num = 0;
+
+
+/*
+ * Display a note in the active window, in pieces
+ */
+static void borg_note_draw(cptr what)
 {
-    int j, n, i, k;
+    int n, i, k;
 
     int w, h, x, y;
 
+    /* Access size */
+    Term_get_size(&w, &h);
 
-    term *old = Term;
-
-    /* Memorize it */
-    message_add(what, MSG_GENERIC);
+    /* Access cursor */
+    Term_locate(&x, &y);
 
+    /* Erase current line */
+    Term_erase(0, y, 255);
 
-    /* Log the message */
-    borg_info(what);
 
+    /* Total length */
+    n = strlen(what);
 
-    /* Mega-Hack -- Check against the search string */
-    if (borg_match[0] && strstr(what, borg_match))
+    /* Too long */
+    if (n > w - 2)
     {
-        /* Clean cancel */
-        borg_cancel = TRUE;
+        char buf[1024];
+
+        /* Split */
+        while (n > w - 2)
+        {
+            /* Default */
+            k = w - 2;
+
+            /* Find a split point */
+            for (i = w / 2; i < w - 2; i++)
+            {
+                /* Pre-emptive split point */
+                if (isspace(what[i])) k = i;
+            }
+
+            /* Copy over the split message */
+            for (i = 0; i < k; i++)
+            {
+                /* Copy */
+                buf[i] = what[i];
+            }
+
+            /* Indicate split */
+            buf[i++] = '\\';
+
+            /* Terminate */
+            buf[i] = '\0';
+
+            /* Show message */
+            Term_addstr(-1, TERM_WHITE, buf);
+
+            /* Advance (wrap) */
+            if (++y >= h) y = 0;
+
+            /* Erase next line */
+            Term_erase(0, y, 255);
+
+            /* Advance */
+            what += k;
+
+            /* Reduce */
+            n -= k;
+        }
+
+        /* Show message tail */
+        Term_addstr(-1, TERM_WHITE, what);
+
+        /* Advance (wrap) */
+        if (++y >= h) y = 0;
+
+        /* Erase next line */
+        Term_erase(0, y, 255);
     }
 
-    /* Mega-Hack -- Check against the swap loops */
-    if (strstr(what, "Best Combo") ||
-	    strstr(what, "Taking off "))
+    /* Normal */
+    else
     {
-        /* Tick the anti loop clock */
-        time_this_panel += 10;
-        borg_note(format("# Anti-loop variable tick (%d).", time_this_panel));
+        /* Show message */
+        Term_addstr(-1, TERM_WHITE, what);
+
+        /* Advance (wrap) */
+        if (++y >= h) y = 0;
+
+        /* Erase next line */
+        Term_erase(0, y, 255);
     }
+}
+
+
+/*
+ * Draw the queued notes in every borg message window
+ */
+void borg_note_flush(void)
+{
+    int j, i;
+
+    term *old = Term;
+
+    /* Nothing queued */
+    if (!borg_note_num) return;
 
     /* Scan windows */
     for (j = 0; j < 8; j++)
@@ -1563,96 +1674,92 @@ void borg_note(cptr what)
         /* Activate */
         Term_activate(angband_term[j]);
 
-        /* Access size */
-        Term_get_size(&w, &h);
-
-        /* Access cursor */
-        Term_locate(&x, &y);
-
-        /* Erase current line */
-        Term_erase(0, y, 255);
-
-
-        /* Total length */
-        n = strlen(what);
-
-        /* Too long */
-        if (n > w - 2)
+        /* Show the notes, oldest first */
+        for (i = 0; i < borg_note_num; i++)
         {
-            char buf[1024];
-
-            /* Split */
-            while (n > w - 2)
-            {
-                /* Default */
-                k = w - 2;
+            borg_note_draw(borg_note_buf + borg_note_pos[i]);
+        }
 
-                /* Find a split point */
-                for (i = w / 2; i < w - 2; i++)
-                {
-                    /* Pre-emptive split point */
-                    if (isspace(what[i])) k = i;
-                }
+        /* Flush output */
+        Term_fresh();
 
-                /* Copy over the split message */
-                for (i = 0; i < k; i++)
-                {
-                    /* Copy */
-                    buf[i] = what[i];
-                }
+        /* Use correct window */
+        Term_activate(old);
+    }
 
-                /* Indicate split */
-                buf[i++] = '\\';
+    /* Empty the queue */
+    borg_note_len = 0;
+    borg_note_num = 0;
+}
 
-                /* Terminate */
-                buf[i] = '\0';
 
-                /* Show message */
-                Term_addstr(-1, TERM_WHITE, buf);
+/*
+ * Queue a note for the borg message windows
+ */
+static void borg_note_queue(cptr what)
+{
+    int j, n;
 
-                /* Advance (wrap) */
-                if (++y >= h) y = 0;
+    /* Only bother if some window shows notes */
+    for (j = 0; j < 8; j++)
+    {
+        if (!angband_term[j]) continue;
+        if (op_ptr->window_flag[j] & PW_BORG_1) break;
+    }
+    if (j == 8) return;
 
-                /* Erase next line */
-                Term_erase(0, y, 255);
+    /* Paranoia -- keep what fits */
+    n = MIN((int)strlen(what), BORG_NOTE_BUF - 1);
 
-                /* Advance */
-                what += k;
+    /* Make room */
+    if ((borg_note_num == BORG_NOTE_MAX) ||
+        (borg_note_len + n + 1 > BORG_NOTE_BUF)) borg_note_flush();
 
-                /* Reduce */
-                n -= k;
-            }
+    /* Copy it in */
+    borg_note_pos[borg_note_num++] = borg_note_len;
+    memcpy(borg_note_buf + borg_note_len, what, n);
+    borg_note_buf[borg_note_len + n] = '\0';
+    borg_note_len += n + 1;
 
-            /* Show message tail */
-            Term_addstr(-1, TERM_WHITE, what);
+    /* Show it now unless the borg is running */
+    if (!borg_active) borg_note_flush();
+}
 
-            /* Advance (wrap) */
-            if (++y >= h) y = 0;
 
-            /* Erase next line */
-            Term_erase(0, y, 255);
-        }
+/*
+ * Memorize a message, Log it, Search it, and queue it for display
+ */
+void borg_note(cptr what)
+{
+    int kind = (what[0] == '&') ? BORG_NOTE_KEYS :
+               (what[0] == '#') ? BORG_NOTE_THINK : BORG_NOTE_OTHER;
 
-        /* Normal */
-        else
-        {
-            /* Show message */
-            Term_addstr(-1, TERM_WHITE, what);
+    /* Memorize it */
+    if (borg_note_mask & kind) message_add(what, MSG_GENERIC);
 
-            /* Advance (wrap) */
-            if (++y >= h) y = 0;
 
-            /* Erase next line */
-            Term_erase(0, y, 255);
-        }
+    /* Log the message */
+    borg_info(what);
 
 
-        /* Flush output */
-        Term_fresh();
+    /* Mega-Hack -- Check against the search string */
+    if (borg_match[0] && strstr(what, borg_match))
+    {
+        /* Clean cancel */
+        borg_cancel = TRUE;
+    }
 
-        /* Use correct window */
-        Term_activate(old);
+    /* Mega-Hack -- Check against the swap loops */
+    if (strstr(what, "Best Combo") ||
+	    strstr(what, "Taking off "))
+    {
+        /* Tick the anti loop clock */
+        time_this_panel += 10;
+        borg_note(format("# Anti-loop variable tick (%d).", time_this_panel));
     }
+
+    /* Queue it for the message windows */
+    if (borg_note_mask & kind) borg_note_queue(what);
  }
 
 
@@ -2409,6 +2516,336 @@ borg_calc_formula(int *formula)
 
 
 
+/*
+ * Forget every entry in a set of spatial buckets
+ */
+void borg_cell_wipe(borg_cells *cells)
+{
+    WIPE(cells, borg_cells);
+}
+
+
+/*
+ * File entry "i" under the cell holding (y,x)
+ */
+void borg_cell_add(borg_cells *cells, int i, int y, int x)
+{
+    byte *head = &cells->head[y >> BORG_CELL_SHIFT][x >> BORG_CELL_SHIFT];
+
+    cells->next[i] = *head;
+    *head = i;
+}
+
+
+/*
+ * Take entry "i" out of the cell holding (y,x)
+ */
+void borg_cell_del(borg_cells *cells, int i, int y, int x)
+{
+    byte *link = &cells->head[y >> BORG_CELL_SHIFT][x >> BORG_CELL_SHIFT];
+
+    /* Find the link to "i" */
+    while (*link && (*link != i)) link = &cells->next[*link];
+
+    /* Unlink it */
+    if (*link) *link = cells->next[i];
+    cells->next[i] = 0;
+}
+
+
+/*
+ * Entry "i" moved from (oy,ox) to (y,x)
+ */
+void borg_cell_move(borg_cells *cells, int i, int oy, int ox, int y, int x)
+{
+    /* Same cell */
+    if (((oy >> BORG_CELL_SHIFT) == (y >> BORG_CELL_SHIFT)) &&
+        ((ox >> BORG_CELL_SHIFT) == (x >> BORG_CELL_SHIFT))) return;
+
+    borg_cell_del(cells, i, oy, ox);
+    borg_cell_add(cells, i, y, x);
+}
+
+
+/*
+ * Collect the entries filed in cells within "d" grids (in both y and x)
+ * of (y,x), in increasing index order, so that callers scanning the
+ * result see the same order as a scan of the whole list.
+ *
+ * Every entry at "distance()" of "d" or less is included, since that
+ * distance is never less than the larger of the two offsets.  Callers
+ * still have to check the distance themselves.
+ *
+ * The hits are marked in a 256 bit set and read back in index order.
+ */
+int borg_cell_query(borg_cells *cells, int y, int x, int d, byte *list)
+{
+    int y1, x1, y2, x2, cy, cx;
+    int i, j, n = 0;
+
+    u32b hit[8];
+    u32b bits;
+
+    C_WIPE(hit, 8, u32b);
+
+    /* Cell bounds, clipped to the map */
+    y1 = MAX(y - d, 0) >> BORG_CELL_SHIFT;
+    x1 = MAX(x - d, 0) >> BORG_CELL_SHIFT;
+    y2 = MIN(y + d, AUTO_MAX_Y - 1) >> BORG_CELL_SHIFT;
+    x2 = MIN(x + d, AUTO_MAX_X - 1) >> BORG_CELL_SHIFT;
+
+    for (cy = y1; cy <= y2; cy++)
+    {
+        for (cx = x1; cx <= x2; cx++)
+        {
+            for (i = cells->head[cy][cx]; i; i = cells->next[i])
+            {
+                hit[i >> 5] |= 1UL << (i & 31);
+            }
+        }
+    }
+
+    /* Read them back in order */
+    for (j = 0; j < 8; j++)
+    {
+        for (bits = hit[j], i = j << 5; bits; bits >>= 1, i++)
+        {
+            if (bits & 1) list[n++] = i;
+        }
+    }
+
+    return (n);
+}
+
+
+/*
+ * Monotonic microseconds, modulo 2^32
+ */
+u32b borg_usec(void)
+{
+#ifdef CLOCK_MONOTONIC
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ((u32b)ts.tv_sec * 1000000UL + (u32b)(ts.tv_nsec / 1000));
+#else
+    return ((u32b)((double)clock() * 1000000.0 / CLOCKS_PER_SEC));
+#endif
+}
+
+
+#ifdef BORG_PROFILE
+
+/*
+ * One profiler slot
+ */
+typedef struct borg_prof borg_prof;
+
+struct borg_prof
+{
+    u32b calls;                     /* Calls timed */
+    double total;                   /* Microseconds spent */
+    u32b max;                       /* Slowest call */
+    u32b hist[BORG_PROF_BINS];      /* Calls by time */
+};
+
+/*
+ * One of the slowest decisions
+ */
+typedef struct borg_prof_turn borg_prof_turn;
+
+struct borg_prof_turn
+{
+    u32b usec;                      /* Time taken */
+    s32b turn;                      /* Game turn */
+    s32b borg_t;                    /* Borg clock */
+    s16b depth;                     /* Current depth */
+    s16b goal;                      /* Flow goal */
+    bool rising, leaving, fleeing, ignoring;
+};
+
+static cptr borg_prof_name[BORG_PROF_MAX] =
+{
+    "think",
+    "update",
+    "notice",
+    "think_store",
+    "think_dungeon",
+    "caution",
+    "attack",
+    "flow_spread",
+    "danger"
+};
+
+static borg_prof borg_profs[BORG_PROF_MAX];
+
+static borg_prof_turn borg_prof_slow[BORG_PROF_SLOW];
+static int borg_prof_slow_num = 0;
+
+/* Start times of the open slots */
+static u32b borg_prof_stack[64];
+static int borg_prof_depth = 0;
+
+
+/*
+ * Remember a decision if it is one of the slowest so far
+ */
+static void borg_prof_note_turn(u32b usec)
+{
+    int i;
+
+    /* Find its place */
+    for (i = borg_prof_slow_num; i > 0; i--)
+    {
+        if (borg_prof_slow[i-1].usec >= usec) break;
+        if (i < BORG_PROF_SLOW) borg_prof_slow[i] = borg_prof_slow[i-1];
+    }
+
+    /* Not slow enough */
+    if (i >= BORG_PROF_SLOW) return;
+
+    if (borg_prof_slow_num < BORG_PROF_SLOW) borg_prof_slow_num++;
+
+    borg_prof_slow[i].usec = usec;
+    borg_prof_slow[i].turn = turn;
+    borg_prof_slow[i].borg_t = borg_t;
+    borg_prof_slow[i].depth = borg_skill[BI_CDEPTH];
+    borg_prof_slow[i].goal = goal;
+    borg_prof_slow[i].rising = goal_rising;
+    borg_prof_slow[i].leaving = goal_leaving;
+    borg_prof_slow[i].fleeing = goal_fleeing;
+    borg_prof_slow[i].ignoring = goal_ignoring;
+}
+
+
+/*
+ * Start timing a slot
+ */
+void borg_prof_enter(int which)
+{
+    (void)which;
+
+    /* Paranoia -- too deep, the matching leave is ignored too */
+    if (borg_prof_depth >= 64)
+    {
+        borg_prof_depth++;
+        return;
+    }
+
+    borg_prof_stack[borg_prof_depth++] = borg_usec();
+}
+
+
+/*
+ * Stop timing a slot, passing "value" through
+ */
+int borg_prof_leave(int which, int value)
+{
+    borg_prof *prof = &borg_profs[which];
+    u32b usec;
+    int bin;
+
+    /* Paranoia */
+    if (borg_prof_depth <= 0) return (value);
+    if (--borg_prof_depth >= 64) return (value);
+
+    usec = borg_usec() - borg_prof_stack[borg_prof_depth];
+
+    /* Count it */
+    prof->calls++;
+    prof->total += usec;
+    if (usec > prof->max) prof->max = usec;
+
+    /* Histogram, by powers of two */
+    for (bin = 0; (bin < BORG_PROF_BINS - 1) && (usec >> (bin + 1)); bin++) /* loop */;
+    prof->hist[bin]++;
+
+    /* Track the slowest decisions */
+    if (which == BORG_PROF_THINK) borg_prof_note_turn(usec);
+
+    return (value);
+}
+
+
+/*
+ * Forget the statistics
+ */
+void borg_prof_reset(void)
+{
+    C_WIPE(borg_profs, BORG_PROF_MAX, borg_prof);
+    borg_prof_slow_num = 0;
+}
+
+
+/*
+ * Write the statistics to a file in the user directory
+ */
+bool borg_prof_dump(cptr name)
+{
+    char buf[1024];
+    ang_file *fff;
+    int i, bin;
+
+    path_build(buf, 1024, ANGBAND_DIR_USER, name);
+
+    /* Hack -- drop permissions */
+    safe_setuid_drop();
+
+    fff = file_open(buf, MODE_WRITE, FTYPE_TEXT);
+
+    /* Hack -- grab permissions */
+    safe_setuid_grab();
+
+    if (!fff) return (FALSE);
+
+    file_putf(fff, "%-14s %10s %12s %10s %10s\n",
+              "slot", "calls", "total ms", "mean us", "max us");
+
+    for (i = 0; i < BORG_PROF_MAX; i++)
+    {
+        borg_prof *prof = &borg_profs[i];
+
+        if (!prof->calls) continue;
+
+        file_putf(fff, "%-14s %10lu %12.1f %10.1f %10lu\n",
+                  borg_prof_name[i], (unsigned long)prof->calls,
+                  prof->total / 1000.0, prof->total / prof->calls,
+                  (unsigned long)prof->max);
+
+        /* Histogram */
+        for (bin = 0; bin < BORG_PROF_BINS; bin++)
+        {
+            if (!prof->hist[bin]) continue;
+
+            file_putf(fff, "    < %8lu us %10lu\n",
+                      2UL << bin, (unsigned long)prof->hist[bin]);
+        }
+    }
+
+    file_putf(fff, "\nSlowest decisions\n");
+
+    for (i = 0; i < borg_prof_slow_num; i++)
+    {
+        borg_prof_turn *t = &borg_prof_slow[i];
+
+        file_putf(fff, "%10lu us  turn %ld  borg_t %ld  depth %d  goal %d%s%s%s%s\n",
+                  (unsigned long)t->usec, (long)t->turn, (long)t->borg_t,
+                  t->depth, t->goal,
+                  t->rising ? " rising" : "",
+                  t->leaving ? " leaving" : "",
+                  t->fleeing ? " fleeing" : "",
+                  t->ignoring ? " ignoring" : "");
+    }
+
+    file_close(fff);
+
+    return (TRUE);
+}
+
+#endif /* BORG_PROFILE */
+
+
+
 
 bool (*borg_sort_comp)(void* u, void* v, int a, int b);
 void (*borg_sort_swap)(void* u, void* v, int a, int b);
@@ -2667,9 +3104,11 @@ if (!borg_rand_local)
     /* No monsters yet */
     borg_kills_cnt = 0;
     borg_kills_nxt = 1;
+    borg_kills_live_n = 0;
 
     /* Array of monsters */
     C_MAKE(borg_kills, 256, borg_kill);
+    C_MAKE(borg_kill_spells, 256, borg_kill_spell);
 
     /* Scan the monsters */
     for (i = 1; i < z_info->r_max-1; i++)
@@ -619,6 +619,9 @@ struct borg_take
 
 /*
  * Monster information
+ *
+ * The fields that the monster loops test first come first, and the
+ * spell lists live apart in "borg_kill_spells[]".
  */
 
 typedef struct borg_kill borg_kill;
@@ -627,9 +630,16 @@ struct borg_kill
 {
     s16b    r_idx;      /* Race index */
 
-    bool    known;      /* Verified race */
+    byte    x, y;       /* Location */
+
+    s16b    when;       /* When last seen */
+
+    byte    speed;      /* Estimated speed */
+
     bool    awake;      /* Probably awake */
 
+    bool    known;      /* Verified race */
+
     bool    confused;   /* Probably confused */
     bool    afraid;     /* Probably afraid */
     bool    quiver;     /* Probably quivering */
@@ -639,19 +649,45 @@ struct borg_kill
     bool    seen;       /* Assigned motion */
     bool    used;       /* Assigned message */
 
-    byte    x, y;       /* Location */
-
     byte    ox, oy;     /* Old location */
 
-    byte    speed;      /* Estimated speed */
     byte    moves;      /* Estimates moves */
     byte    ranged_attack; /* qty of ranged attacks */
-    byte	spell[96];		/* spell flag for monster spells */
     s16b    power;      /* Estimated hit-points */
     s16b    other;      /* Estimated something */
     s16b    level;      /* Monsters Level */
+};
+
+
+/*
+ * Monster spell information, one per "borg_kills[]" entry
+ */
+
+typedef struct borg_kill_spell borg_kill_spell;
+
+struct borg_kill_spell
+{
+    byte	spell[96];		/* spell flag for monster spells */
 	u32b	spell_flags[RF_MAX]; /* Monster race spell flags preloaded */
-    s16b    when;       /* When last seen */
+};
+
+
+/*
+ * Spatial buckets over the map.  Each 8x8 cell keeps a list of the
+ * "borg_kills[]" or "borg_takes[]" indexes standing in it, so that
+ * lookups near a grid only visit the entries close to it.
+ */
+
+#define BORG_CELL_SHIFT 3
+#define BORG_CELL_HGT   ((AUTO_MAX_Y >> BORG_CELL_SHIFT) + 1)
+#define BORG_CELL_WID   ((AUTO_MAX_X >> BORG_CELL_SHIFT) + 1)
+
+typedef struct borg_cells borg_cells;
+
+struct borg_cells
+{
+    byte head[BORG_CELL_HGT][BORG_CELL_WID];   /* First entry in each cell */
+    byte next[256];                            /* Next entry in the same cell */
 };
 
 
@@ -796,6 +832,7 @@ extern bool borg_plays_risky;
 extern bool borg_uses_swaps;
 extern bool borg_uses_calcs;
 extern bool borg_slow_optimizehome;
+extern int borg_home_budget;
 extern bool borg_scums_uniques;
 extern bool borg_kills_uniques;
 extern int borg_chest_fail_tolerance;
@@ -806,8 +843,19 @@ extern bool borg_self_scum;
 extern bool borg_lunal_mode;
 extern bool borg_self_lunal;
 extern bool borg_verbose;
+extern int borg_note_mask;
+
+/*
+ * Kinds of note, by their first character, for "borg_note_mask"
+ */
+#define BORG_NOTE_KEYS  0x01    /* "& Key" keypresses */
+#define BORG_NOTE_THINK 0x02    /* "# " thoughts */
+#define BORG_NOTE_OTHER 0x04    /* Everything else */
+#define BORG_NOTE_ALL   0x07
 extern bool borg_munchkin_start;
 extern bool borg_munchkin_mode;
+extern bool borg_turbo;
+extern int borg_turbo_snapshot;
 
 /* HACK... this should really be a parm into borg_prepared */
 /*         I am just being lazy */
@@ -1101,6 +1149,14 @@ extern u32b borg_rand_value;        /* Save system setting */
 
 extern u32b borg_rand_local;        /* Save personal setting */
 
+/*
+ * Session journal (see the 'j' command)
+ */
+#define BORG_JOURNAL_RECORD 1   /* Writing keys to the journal */
+#define BORG_JOURNAL_PLAY   2   /* Checking keys against the journal */
+
+extern byte borg_journal;           /* Recording or replaying a session */
+
 
 /*
  * Hack -- time variables
@@ -1737,6 +1793,19 @@ extern s16b borg_kills_summoner;   /* index of a summoning guy */
 extern s16b borg_kills_nxt;
 
 extern borg_kill *borg_kills;
+extern borg_kill_spell *borg_kill_spells;
+
+/*
+ * The live monsters, in index order, so loops can skip the dead ones
+ */
+extern byte borg_kills_live[256];
+extern s16b borg_kills_live_n;
+
+/*
+ * The takes and kills, bucketed by location
+ */
+extern borg_cells borg_take_cells;
+extern borg_cells borg_kill_cells;
 
 
 /*
@@ -1873,6 +1942,18 @@ extern borg_data *borg_data_icky;   /* Current "icky" flags */
 
 extern bool borg_danger_wipe;       /* Recalculate danger */
 
+extern u32b borg_flow_epoch;        /* Cached flows older than this are stale */
+
+extern s32b borg_flow_hits;         /* Flows served from the flow cache */
+
+extern s32b borg_flow_builds;       /* Flows spread from scratch */
+
+extern s32b borg_map_cells;         /* Panel grids scanned by borg_update_map() */
+
+extern s32b borg_map_examined;      /* Panel grids worked through */
+
+extern s32b borg_map_changed;       /* Panel grids with a new glyph */
+
 extern bool borg_do_update_view;       /* Recalculate view */
 
 extern bool borg_do_update_LIGHT;       /* Recalculate lite */
@@ -1941,6 +2022,11 @@ extern char borg_inkey(bool take);
  */
 extern void borg_flush(void);
 
+/*
+ * Draw the notes queued by borg_note()
+ */
+extern void borg_note_flush(void);
+
 
 /*
  * Obtain some text from the screen (single character)
@@ -2009,6 +2095,60 @@ extern int borg_check_formula(int *);
  */
 extern cptr borg_prt_formula(int *formula);
 
+/*
+ * Spatial buckets -- keep in step with the takes and kills
+ */
+extern void borg_cell_wipe(borg_cells *cells);
+extern void borg_cell_add(borg_cells *cells, int i, int y, int x);
+extern void borg_cell_del(borg_cells *cells, int i, int y, int x);
+extern void borg_cell_move(borg_cells *cells, int i, int oy, int ox, int y, int x);
+extern int borg_cell_query(borg_cells *cells, int y, int x, int d, byte *list);
+
+
+/*
+ * Wall clock in microseconds, for timing only
+ */
+extern u32b borg_usec(void);
+
+/*
+ * Hot path profiler (compile with BORG_PROFILE).  Each slot counts its
+ * calls and keeps a histogram of their run times, bin "n" holding the
+ * calls that took less than 2^(n+1) microseconds.  Times are inclusive
+ * of nested slots.
+ */
+#define BORG_PROF_THINK     0   /* borg_think(), one decision */
+#define BORG_PROF_UPDATE    1   /* borg_update() */
+#define BORG_PROF_NOTICE    2   /* borg_notice() */
+#define BORG_PROF_STORE     3   /* borg_think_store() */
+#define BORG_PROF_DUNGEON   4   /* borg_think_dungeon() */
+#define BORG_PROF_CAUTION   5   /* borg_caution() */
+#define BORG_PROF_ATTACK    6   /* borg_attack() */
+#define BORG_PROF_SPREAD    7   /* borg_flow_spread() */
+#define BORG_PROF_DANGER    8   /* borg_danger() */
+#define BORG_PROF_MAX       9
+
+#define BORG_PROF_BINS      24
+#define BORG_PROF_SLOW      16  /* Slowest decisions kept */
+
+#ifdef BORG_PROFILE
+
+extern void borg_prof_enter(int which);
+extern int borg_prof_leave(int which, int value);
+extern void borg_prof_reset(void);
+extern bool borg_prof_dump(cptr name);
+
+#define BORG_PROF_ENTER(W)      borg_prof_enter(W)
+#define BORG_PROF_LEAVE(W)      ((void)borg_prof_leave(W, 0))
+#define BORG_PROF_CALL(W, E)    (borg_prof_enter(W), borg_prof_leave(W, (E)))
+
+#else
+
+#define BORG_PROF_ENTER(W)      ((void)0)
+#define BORG_PROF_LEAVE(W)      ((void)0)
+#define BORG_PROF_CALL(W, E)    (E)
+
+#endif /* BORG_PROFILE */
+
 /*
  * Print the string for an item
  */
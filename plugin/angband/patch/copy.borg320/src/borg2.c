@@ -46,12 +46,132 @@ bool borg_cave_floor_bold(int Y, int X)
 	return (FALSE);
 }
 
+
+/*
+ * Projection rays -- the path "mmove2()" takes from a grid to each
+ * offset within MAX_RANGE, worked out once in "borg_init_2()".  The
+ * steps are stored as offsets biased by MAX_RANGE, and "borg_ray_len"
+ * is the step that reaches the target (more than MAX_RANGE if none).
+ */
+#define BORG_RAY_SIDE   (MAX_RANGE * 2 + 1)
+#define BORG_RAY_NUM    (BORG_RAY_SIDE * BORG_RAY_SIDE)
+#define BORG_RAY_STEPS  (MAX_RANGE + 1)
+
+static byte *borg_ray_y;
+static byte *borg_ray_x;
+static byte *borg_ray_len;
+
+
+/*
+ * Projection cache -- which targets near an origin can be reached.
+ *
+ * Each entry covers the targets within MAX_RANGE of one origin, for
+ * one question ("borg_los()", or "borg_projectable()" with a given
+ * reach into unknown grids), with one bit saying the answer is known
+ * and one holding it.  Entries are good while "borg_flow_epoch" is
+ * unchanged, which covers map changes and the start of each update.
+ */
+#define BORG_PROJ_WORDS     ((BORG_RAY_NUM + 31) / 32)
+#define BORG_PROJ_CACHE_MAX 256
+#define BORG_PROJ_LOS       (-1)
+
+typedef struct borg_proj_entry borg_proj_entry;
+
+struct borg_proj_entry
+{
+    u32b epoch;
+    s16b y, x;          /* Origin */
+    s16b mode;          /* Unknown grid reach, or BORG_PROJ_LOS */
+
+    u32b known[BORG_PROJ_WORDS];
+    u32b okay[BORG_PROJ_WORDS];
+};
+
+static borg_proj_entry *borg_proj_cache;
+
+s32b borg_proj_hits = 0;
+s32b borg_proj_misses = 0;
+
+
+/*
+ * Find the ray to an offset, or -1 if it is out of range
+ */
+static int borg_ray_index(int dy, int dx)
+{
+    if (ABS(dy) > MAX_RANGE || ABS(dx) > MAX_RANGE) return (-1);
+
+    return ((dy + MAX_RANGE) * BORG_RAY_SIDE + (dx + MAX_RANGE));
+}
+
+
+/*
+ * Get the cache entry for an origin and question
+ */
+static borg_proj_entry *borg_proj_find(int y, int x, int mode)
+{
+    int h = ((y * AUTO_MAX_X + x) * 7 + mode) & (BORG_PROJ_CACHE_MAX - 1);
+
+    borg_proj_entry *pe = &borg_proj_cache[h];
+
+    /* Start over */
+    if (pe->epoch != borg_flow_epoch || pe->y != y || pe->x != x ||
+        pe->mode != mode)
+    {
+        pe->epoch = borg_flow_epoch;
+        pe->y = y;
+        pe->x = x;
+        pe->mode = mode;
+        C_WIPE(pe->known, BORG_PROJ_WORDS, u32b);
+    }
+
+    return (pe);
+}
+
+
+/*
+ * Walk a ray from (y1,x1) to (y2,x2) as "borg_projectable()" does.
+ * Unknown grids further than "reach" along the path stop it.
+ */
+static bool borg_ray_project(int y1, int x1, int y2, int x2, int reach)
+{
+    int r, dist, len;
+
+    borg_grid *ag;
+
+    /* Out of range */
+    r = borg_ray_index(y2 - y1, x2 - x1);
+    if (r < 0) return (FALSE);
+
+    /* Never gets there */
+    len = borg_ray_len[r];
+    if (len > MAX_RANGE) return (FALSE);
+
+    /* Simulate the spell/missile path */
+    for (dist = 0; dist <= len; dist++)
+    {
+        int k = r * BORG_RAY_STEPS + dist;
+
+        /* Get the grid */
+        ag = &borg_grids[y1 + borg_ray_y[k] - MAX_RANGE]
+                        [x1 + borg_ray_x[k] - MAX_RANGE];
+
+        /* Unknown grids too far away are walls */
+        if ((dist > reach) && (ag->feat == FEAT_NONE)) return (FALSE);
+
+        /* Never pass through walls/doors */
+        if (dist && (!borg_cave_floor_grid(ag))) return (FALSE);
+    }
+
+    /* Arrived at "final target" */
+    return (TRUE);
+}
+
 /*
  * A simple, fast, integer-based line-of-sight algorithm.
  *
  * See "los()" in "cave.c" for complete documentation
  */
-bool borg_los(int y1, int x1, int y2, int x2)
+static bool borg_los_aux(int y1, int x1, int y2, int x2)
 {
 
     /* Delta */
@@ -276,6 +396,40 @@ bool borg_los(int y1, int x1, int y2, int x2)
 
 }
 
+
+/*
+ * Line of sight, remembered in the projection cache
+ */
+bool borg_los(int y1, int x1, int y2, int x2)
+{
+    int r = borg_ray_index(y2 - y1, x2 - x1);
+
+    borg_proj_entry *pe;
+
+    /* Out of range of the cache */
+    if (r < 0) return (borg_los_aux(y1, x1, y2, x2));
+
+    pe = borg_proj_find(y1, x1, BORG_PROJ_LOS);
+
+    /* Known */
+    if (pe->known[r >> 5] & (1UL << (r & 31)))
+    {
+        borg_proj_hits++;
+        return ((pe->okay[r >> 5] & (1UL << (r & 31))) ? TRUE : FALSE);
+    }
+
+    /* Work it out */
+    borg_proj_misses++;
+    pe->known[r >> 5] |= (1UL << (r & 31));
+    if (borg_los_aux(y1, x1, y2, x2))
+    {
+        pe->okay[r >> 5] |= (1UL << (r & 31));
+        return (TRUE);
+    }
+    pe->okay[r >> 5] &= ~(1UL << (r & 31));
+    return (FALSE);
+}
+
 /*
  * Check the projection from (x1,y1) to (x2,y2).
  * Assume that there is no monster in the way.
@@ -284,73 +438,76 @@ bool borg_los(int y1, int x1, int y2, int x2)
  */
 bool borg_projectable(int y1, int x1, int y2, int x2)
 {
-    int dist, y, x;
-
-    borg_grid *ag;
+    int r, reach;
 
-    /* Start at the initial location */
-    y = y1; x = x1;
+    borg_proj_entry *pe;
 
-    /* Simulate the spell/missile path */
-    for (dist = 0; dist <= MAX_RANGE; dist++)
+    if ((borg_skill[BI_CURHP] < borg_skill[BI_MAXHP] / 3 ||
+        borg_morgoth_position || scaryguy_on_level))
     {
-        /* Get the grid */
-        ag = &borg_grids[y][x];
+        /* Assume all unknown grids more than distance 20 from you
+         * are walls--when I am wounded. This will make me more fearful
+         * of the grids that are up to 19 spaces away.  I treat them as
+         * regular floor grids.  Which means monsters are assumed to have
+         * LOS on me.  I am also more likely to shoot into the dark grids.
+         */
+        reach = 20;
+    }
+    else if (borg_skill[BI_CURHP] < borg_skill[BI_MAXHP] / 2)
+    {
+        /* Assume all unknow grids more than distance 10 from you
+         * are walls--when I am wounded. This will make me more fearful
+         * of the grids that are up to 9 spaces away.  I treat them as
+         * regular floor grids.
+         */
+        reach = 10;
+    }
+	else if (borg_fear_region[c_y/11][c_x/11] >= avoidance / 20)
+	{
+		/* If a non-LOS monster is attacking me, then it is probably has
+		 * LOS to me, so do not place walls on unknown grids.  This will allow
+		 * me the chance to attack monsters.
+		 *
+		 * This does not work if the non-LOS monster is invisible.
+		 * This helps in a case like this:
+		 *####################			1.  Player has ESP and can sense the priest.
+		 *......@......      p			2.  Priest has cast a spell at the player.
+		 *#############					3.  Unknown grids are between player and priest
+		 *								4.  Borg has created regional fear from non-LOS priest.
+		 *
+		 */
+        reach = MAX_RANGE;
+	}
+    else
+    {
+        /* Assume all unknow grids more than distance 3 from you
+         * are walls.  This makes me brave and chancey.
+         */
+        reach = 2;
+    }
 
-        if ((borg_skill[BI_CURHP] < borg_skill[BI_MAXHP] / 3 ||
-            borg_morgoth_position || scaryguy_on_level))
-        {
-            /* Assume all unknown grids more than distance 20 from you
-             * are walls--when I am wounded. This will make me more fearful
-             * of the grids that are up to 19 spaces away.  I treat them as
-             * regular floor grids.  Which means monsters are assumed to have
-             * LOS on me.  I am also more likely to shoot into the dark grids.
-             */
-            if ((dist > 20) && (ag->feat == FEAT_NONE)) break;
-        }
-        else if (borg_skill[BI_CURHP] < borg_skill[BI_MAXHP] / 2)
-        {
-            /* Assume all unknow grids more than distance 10 from you
-             * are walls--when I am wounded. This will make me more fearful
-             * of the grids that are up to 9 spaces away.  I treat them as
-             * regular floor grids.
-             */
-            if ((dist > 10) && (ag->feat == FEAT_NONE)) break;
-        }
-		else if (borg_fear_region[c_y/11][c_x/11] >= avoidance / 20)
-		{
-			/* If a non-LOS monster is attacking me, then it is probably has
-			 * LOS to me, so do not place walls on unknown grids.  This will allow
-			 * me the chance to attack monsters.
-			 *
-			 * This does not work if the non-LOS monster is invisible.
-			 * This helps in a case like this:
-			 *####################			1.  Player has ESP and can sense the priest.
-			 *......@......      p			2.  Priest has cast a spell at the player.
-			 *#############					3.  Unknown grids are between player and priest
-			 *								4.  Borg has created regional fear from non-LOS priest.
-			 *
-			 */
-            if ((dist > MAX_RANGE) && (ag->feat == FEAT_NONE)) break;
-		}
-        else
-        {
-            /* Assume all unknow grids more than distance 3 from you
-             * are walls.  This makes me brave and chancey.
-             */
-            if ((dist > 2) && (ag->feat == FEAT_NONE)) break;
-        }
-        /* Never pass through walls/doors */
-        if (dist && (!borg_cave_floor_grid(ag))) break;
+    /* Out of range */
+    r = borg_ray_index(y2 - y1, x2 - x1);
+    if (r < 0) return (FALSE);
 
-        /* Check for arrival at "final target" */
-        if ((x == x2) && (y == y2)) return (TRUE);
+    pe = borg_proj_find(y1, x1, reach);
 
-        /* Calculate the new location */
-        mmove2(&y, &x, y1, x1, y2, x2);
+    /* Known */
+    if (pe->known[r >> 5] & (1UL << (r & 31)))
+    {
+        borg_proj_hits++;
+        return ((pe->okay[r >> 5] & (1UL << (r & 31))) ? TRUE : FALSE);
     }
 
-    /* Assume obstruction */
+    /* Work it out */
+    borg_proj_misses++;
+    pe->known[r >> 5] |= (1UL << (r & 31));
+    if (borg_ray_project(y1, x1, y2, x2, reach))
+    {
+        pe->okay[r >> 5] |= (1UL << (r & 31));
+        return (TRUE);
+    }
+    pe->okay[r >> 5] &= ~(1UL << (r & 31));
     return (FALSE);
 }
 
@@ -364,34 +521,8 @@ bool borg_projectable(int y1, int x1, int y2, int x2)
  */
 bool borg_offset_projectable(int y1, int x1, int y2, int x2)
 {
-    int dist, y, x;
-
-    borg_grid *ag;
-
-    /* Start at the initial location */
-    y = y1; x = x1;
-
-    /* Simulate the spell/missile path */
-    for (dist = 0; dist <= MAX_RANGE; dist++)
-    {
-        /* Get the grid */
-        ag = &borg_grids[y][x];
-
-        /* Assume all unknown grids are walls. */
-        if ((dist) && (ag->feat == FEAT_NONE)) break;
-
-        /* Never pass through walls/doors */
-        if (dist && (!borg_cave_floor_grid(ag))) break;
-
-        /* Check for arrival at "final target" */
-        if ((x == x2) && (y == y2)) return (TRUE);
-
-        /* Calculate the new location */
-        mmove2(&y, &x, y1, x1, y2, x2);
-    }
-
-    /* Assume obstruction */
-    return (FALSE);
+    /* Assume all unknown grids are walls. */
+    return (borg_ray_project(y1, x1, y2, x2, 0));
 }
 
 
@@ -404,16 +535,20 @@ bool borg_offset_projectable(int y1, int x1, int y2, int x2)
  */
 bool borg_projectable_pure(int y1, int x1, int y2, int x2)
 {
-    int dist, y, x;
+    int dist, y, x, r, len;
     borg_grid *ag;
 
-    /* Start at the initial location */
-    y = y1; x = x1;
+    /* Out of range */
+    r = borg_ray_index(y2 - y1, x2 - x1);
+    if (r < 0) return (FALSE);
+    len = MIN(borg_ray_len[r], MAX_RANGE);
 
     /* Simulate the spell/missile path */
-    for (dist = 0; dist <= MAX_RANGE; dist++)
+    for (dist = 0; dist <= len; dist++)
     {
         /* Get the grid */
+        y = y1 + borg_ray_y[r * BORG_RAY_STEPS + dist] - MAX_RANGE;
+        x = x1 + borg_ray_x[r * BORG_RAY_STEPS + dist] - MAX_RANGE;
         ag = &borg_grids[y][x];
 
         /* Hack -- assume unknown grids are walls */
@@ -427,9 +562,6 @@ bool borg_projectable_pure(int y1, int x1, int y2, int x2)
 
         /* Stop at monsters */
         if (ag->kill) break;
-
-        /* Calculate the new location */
-        mmove2(&y, &x, y1, x1, y2, x2);
     }
 
     /* Assume obstruction */
@@ -448,17 +580,21 @@ bool borg_projectable_pure(int y1, int x1, int y2, int x2)
  */
 bool borg_projectable_dark(int y1, int x1, int y2, int x2)
 {
-    int dist, y, x;
+    int dist, y, x, r, len;
     int unknown = 0;
     borg_grid *ag;
 
-    /* Start at the initial location */
-    y = y1; x = x1;
+    /* Out of range */
+    r = borg_ray_index(y2 - y1, x2 - x1);
+    if (r < 0) return (FALSE);
+    len = MIN(borg_ray_len[r], MAX_RANGE);
 
     /* Simulate the spell/missile path */
-    for (dist = 0; dist <= MAX_RANGE; dist++)
+    for (dist = 0; dist <= len; dist++)
     {
         /* Get the grid */
+        y = y1 + borg_ray_y[r * BORG_RAY_STEPS + dist] - MAX_RANGE;
+        x = x1 + borg_ray_x[r * BORG_RAY_STEPS + dist] - MAX_RANGE;
         ag = &borg_grids[y][x];
 
         /* We want at least 1 unknown grid */
@@ -472,9 +608,6 @@ bool borg_projectable_dark(int y1, int x1, int y2, int x2)
 
         /* Stop at monsters */
         if (ag->kill) break;
-
-        /* Calculate the new location */
-        mmove2(&y, &x, y1, x1, y2, x2);
     }
 
     /* Assume obstruction */
@@ -1292,7 +1425,44 @@ void borg_update_view(void)
  */
 void borg_init_2(void)
 {
-    /* Nothing */
+    int dy, dx, r, k, y, x;
+
+    /*** Projection rays ***/
+
+    C_MAKE(borg_ray_y, BORG_RAY_NUM * BORG_RAY_STEPS, byte);
+    C_MAKE(borg_ray_x, BORG_RAY_NUM * BORG_RAY_STEPS, byte);
+    C_MAKE(borg_ray_len, BORG_RAY_NUM, byte);
+
+    for (dy = -MAX_RANGE; dy <= MAX_RANGE; dy++)
+    {
+        for (dx = -MAX_RANGE; dx <= MAX_RANGE; dx++)
+        {
+            r = borg_ray_index(dy, dx);
+
+            /* Follow "mmove2()" from a far-away origin */
+            y = 128; x = 128;
+            borg_ray_len[r] = BORG_RAY_STEPS;
+
+            for (k = 0; k < BORG_RAY_STEPS; k++)
+            {
+                borg_ray_y[r * BORG_RAY_STEPS + k] = y - 128 + MAX_RANGE;
+                borg_ray_x[r * BORG_RAY_STEPS + k] = x - 128 + MAX_RANGE;
+
+                /* Arrived */
+                if ((y == 128 + dy) && (x == 128 + dx))
+                {
+                    borg_ray_len[r] = k;
+                    break;
+                }
+
+                mmove2(&y, &x, 128, 128, 128 + dy, 128 + dx);
+            }
+        }
+    }
+
+    /*** Projection cache ***/
+
+    C_MAKE(borg_proj_cache, BORG_PROJ_CACHE_MAX, borg_proj_entry);
 }
 
 
@@ -35,6 +35,12 @@ extern bool borg_cave_floor_bold(int Y, int X);
  */
 extern bool borg_los(int y1, int x1, int y2, int x2);
 
+/*
+ * Projection cache answers, and answers worked out
+ */
+extern s32b borg_proj_hits;
+extern s32b borg_proj_misses;
+
 
 /*
  * Check the projection from (x1,y1) to (x2,y2)
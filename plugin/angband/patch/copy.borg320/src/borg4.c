@@ -151,10 +151,10 @@ static void borg_notice_aux1(void)
 	{
 		borg_skill[BI_CRSFEAR] = TRUE;
 	}
-	if (rf_has(f, OF_VULN_FIRE)) borg_skill[BI_CRSFVULN] = TRUE;
-	if (rf_has(f, OF_VULN_ACID)) borg_skill[BI_CRSAVULN] = TRUE;
-	if (rf_has(f, OF_VULN_COLD)) borg_skill[BI_CRSCVULN] = TRUE;
-	if (rf_has(f, OF_VULN_ELEC)) borg_skill[BI_CRSEVULN] = TRUE;
+	if (rf_has(f, OF_VULN_FIRE)) borg_skill[BI_CRSFVULN] = TRUE;
+	if (rf_has(f, OF_VULN_ACID)) borg_skill[BI_CRSAVULN] = TRUE;
+	if (rf_has(f, OF_VULN_COLD)) borg_skill[BI_CRSCVULN] = TRUE;
+	if (rf_has(f, OF_VULN_ELEC)) borg_skill[BI_CRSEVULN] = TRUE;
 
     /* Immunity flags */
     if (rf_has(f, OF_IM_FIRE)) borg_skill[BI_IFIRE] = TRUE;
@@ -279,10 +279,10 @@ static void borg_notice_aux1(void)
 		{
 			borg_skill[BI_CRSFEAR] = TRUE;
 		}
-		if (of_has(item->flags, OF_VULN_FIRE)) borg_skill[BI_CRSFVULN] = TRUE;
-		if (of_has(item->flags, OF_VULN_ACID)) borg_skill[BI_CRSAVULN] = TRUE;
-		if (of_has(item->flags, OF_VULN_COLD)) borg_skill[BI_CRSCVULN] = TRUE;
-		if (of_has(item->flags, OF_VULN_ELEC)) borg_skill[BI_CRSEVULN] = TRUE;
+		if (of_has(item->flags, OF_VULN_FIRE)) borg_skill[BI_CRSFVULN] = TRUE;
+		if (of_has(item->flags, OF_VULN_ACID)) borg_skill[BI_CRSAVULN] = TRUE;
+		if (of_has(item->flags, OF_VULN_COLD)) borg_skill[BI_CRSCVULN] = TRUE;
+		if (of_has(item->flags, OF_VULN_ELEC)) borg_skill[BI_CRSEVULN] = TRUE;
 
 
         if (of_has(item->flags, OF_REGEN)) borg_skill[BI_REG] = TRUE;
@@ -681,14 +681,14 @@ static void borg_notice_aux1(void)
 
 
 	/*** Some penalties to consider ***/
-
-	/* Fear from spell or effect or flag */
-	if (borg_skill[BI_ISAFRAID] || borg_skill[BI_CRSFEAR])
-	{
-		borg_skill[BI_TOHIT] -= 20;
-		borg_skill[BI_ARMOR] += 8;
-		borg_skill[BI_DEV] = borg_skill[BI_DEV] * 95 / 100;
-	}
+
+	/* Fear from spell or effect or flag */
+	if (borg_skill[BI_ISAFRAID] || borg_skill[BI_CRSFEAR])
+	{
+		borg_skill[BI_TOHIT] -= 20;
+		borg_skill[BI_ARMOR] += 8;
+		borg_skill[BI_DEV] = borg_skill[BI_DEV] * 95 / 100;
+	}
 
     /* priest weapon penalty for non-blessed edged weapons */
     if (player_has(PF_BLESS_WEAPON) &&
@@ -2935,6 +2935,9 @@ void borg_notice(bool notice_swap)
     /* Apply "encumbrance" from weight */
     if (inven_weight > carry_capacity/2) borg_skill[BI_SPEED] -= ((inven_weight - (carry_capacity/2)) / (carry_capacity / 10));
 
+    /* Danger depends on most of the above */
+    borg_danger_wipe_map();
+    borg_threat_sync();
 }
 
 /*
@@ -5586,14 +5589,8 @@ s32b borg_power(void)
     value += borg_power_aux2();
 
     /* Add a bonus for deep level prep */
-    /* Dump prep codes */
-   /* Scan from surface to deep , stop when not preped */
-    for (i = 1; i <= borg_skill[BI_MAXDEPTH]+50; i++)
-    {
-        /* Dump fear code*/
-        if ((cptr)NULL != borg_prepared(i)) break;
-    }
-   	value +=((i-1) * 40000L);
+    i = borg_prepared_depth(borg_skill[BI_MAXDEPTH]+50);
+   	value +=(i * 40000L);
 
     /* Add the value for the swap items */
     value += weapon_swap_value;
@@ -6236,16 +6233,15 @@ s32b borg_power_home(void)
 
 
 /*
- * Calculate base danger from a monster's physical attacks
+ * Calculate base danger from a race's physical attacks
  *
  * We attempt to take account of various resistances, both in
  * terms of actual damage, and special effects, as appropriate.
  *
- * We reduce the danger from distant "sleeping" monsters.
  * PFE reduces my fear of an area.
  *
  */
-static int borg_danger_aux1(int i, bool full_damage)
+static int borg_danger_melee(monster_race *r_ptr, bool full_damage)
 {
     int k, n = 0;
     int pfe = 0;
@@ -6253,10 +6249,6 @@ static int borg_danger_aux1(int i, bool full_damage)
 
     s16b ac = borg_skill[BI_ARMOR];
 
-    borg_kill *kill = &borg_kills[i];
-
-    monster_race *r_ptr = &r_info[kill->r_idx];
-
     /* shields gives +50 to ac and deflects some missiles and balls*/
     if (borg_shield)
         ac += 50;
@@ -6271,9 +6263,6 @@ static int borg_danger_aux1(int i, bool full_damage)
         }
 
 
-    /* Mega-Hack -- unknown monsters */
-    if (kill->r_idx >= z_info->r_max) return (1000);
-
     /* Analyze each physical attack */
     for (k = 0; k < 4; k++)
     {
@@ -6649,806 +6638,768 @@ static int borg_danger_aux1(int i, bool full_damage)
 
 
 /*
- * Calculate base danger from a monster's spell attacks
- *
- * We attempt to take account of various resistances, both in
- * terms of actual damage, and special effects, as appropriate.
- *
- * We reduce the danger from distant "sleeping" monsters.
- *
- * We reduce the danger if the monster is immobile or not LOS
+ * Spells whose danger depends only on the race and the borg's defences.
+ * Breaths scale with the monster's hit points, Forget looks at the
+ * borg's current mana, and summons look at the grids around the borg.
  */
-static int borg_danger_aux2(int i, int y, int x, bool average, bool full_damage)
+static bool borg_danger_spell_fixed(int spell)
 {
-    int q, n= 0, pfe =0, glyph= 0, glyph_check =0;
-
-    int spot_x, spot_y, spot_safe=1;
-
-    int lev, hp, total_dam = 0, av;
-
-    borg_kill *kill = &borg_kills[i];
-
-    borg_grid   *ag;
+    /* Breaths */
+    if (spell >= 32+8 && spell <= 32+26) return (FALSE);
 
-    monster_race *r_ptr = &r_info[kill->r_idx];
-
-    /*  PFE gives a protection.  */
-        /* Hack -- Apply "protection from evil" */
-        if ( (borg_prot_from_evil) &&
-            (rf_has(r_ptr->flags, RF_EVIL)) &&
-            ((borg_skill[BI_CLEVEL] ) >= r_ptr->level) )
-        {
-            pfe = 1;
-        }
+    /* Forget */
+    if (spell == 96+14) return (FALSE);
 
-    /* glyph of warding rune of protection provides some small
-     * protection with some ranged atacks; mainly summon attacks.
-     * We should reduce the danger commensurate to the probability of the
-     * monster breaking the glyph as defined by melee2.c
-     */
-    if (borg_on_glyph)
-    {
-        glyph = 1;
-    }
-    else if (track_glyph_num)
-    {
-        /* Check all existing glyphs */
-        for (glyph_check = 0; glyph_check < track_glyph_num; glyph_check++)
-        {
-            if ((track_glyph_y[glyph_check] == y) && (track_glyph_x[glyph_check] == x))
-            {
-                /* Reduce the danger */
-                glyph = 1;
-            }
-        }
-    }
+    /* Summons */
+    if (spell >= 96+16) return (FALSE);
 
-    /* Mega-Hack -- unknown monsters */
-    if (kill->r_idx >= z_info->r_max) return (1000);
+    /* Fixed */
+    return (TRUE);
+}
 
 
-    /* Paranoia -- Nothing to cast */
-	if (!kill->ranged_attack) return (0);
+/*
+ * Calculate the danger from one monster spell
+ *
+ * The count of guarded grids next to the borg ("safe") carries over
+ * from one summoning spell to the next.
+ */
+static int borg_danger_spell(int spell, int lev, int hp, int pfe, int glyph, int *safe)
+{
+    int p = 0;
 
+    int z = 0;
 
-    /* Extract the level */
-    lev = r_ptr->level;
+    int x, y;
 
-    /* Extract hit-points */
-    hp = kill->power;
+    int spot_x, spot_y, spot_safe = *safe;
 
+    borg_grid *ag;
 
-    /* Analyze the spells */
-	for (q = 0; q < kill->ranged_attack; q++)
+    /* Cast the spell. */
+    switch (spell)
     {
-        int p = 0;
-
-        int z = 0;
+        case 32+0:    /* RF4_SHRIEK */
+        /* if looking at full damage, things that are just annoying */
+        /* do not count.*/
+        /* Add fear for the effect */
+            p += 5;
+        break;
 
-        /* Cast the spell. */
-        switch (kill->spell[q])
-        {
-            case 32+0:    /* RF4_SHRIEK */
-            /* if looking at full damage, things that are just annoying */
-            /* do not count.*/
-            /* Add fear for the effect */
-                p += 5;
-            break;
+        case 32+1:    /* RF4_XXX2X4 */
+        /* this is now a failed spell attempt for monsters */
+        /* used to recognize invisible/ hidden monsters */
+            p += 10;
+        break;
 
-            case 32+1:    /* RF4_XXX2X4 */
-            /* this is now a failed spell attempt for monsters */
-            /* used to recognize invisible/ hidden monsters */
-                p += 10;
-            break;
+        case 32+2:    /* RF4_XXX3X4 */
+        break;
 
-            case 32+2:    /* RF4_XXX3X4 */
-            break;
+        case 32+3:    /* RF4_XXX4X4 */
+        break;
 
-            case 32+3:    /* RF4_XXX4X4 */
-            break;
+        case 32+4:    /* RF4_ARROW_1 */
+        z = (1 * 6);
+        break;
 
-            case 32+4:    /* RF4_ARROW_1 */
-            z = (1 * 6);
-            break;
+        case 32+5:    /* RF4_ARROW_2 */
+        z = (3 * 6);
+        break;
 
-            case 32+5:    /* RF4_ARROW_2 */
-            z = (3 * 6);
-            break;
+        case 32+6:    /* RF4_ARROW_3 */
+        z = (5 * 6);
+        break;
 
-            case 32+6:    /* RF4_ARROW_3 */
-            z = (5 * 6);
-            break;
+        case 32+7:    /* RF4_ARROW_4 */
+        z = (7 * 6);
+        break;
 
-            case 32+7:    /* RF4_ARROW_4 */
-            z = (7 * 6);
-            break;
+        case 32+8:    /* RF4_BR_ACID */
+        if (borg_skill[BI_IACID]) break;
+        z = (hp / 3);
+        /* max damage */
+        if (z > 1600)
+            z = 1600;
+        if (borg_skill[BI_RACID]) z = (z + 2) / 3;
+        if (my_oppose_acid) z = (z + 2) / 3;
+        /* if looking at full damage, things that are just annoying */
+        /* do not count.*/
+        /* Add fear for the effect */
+            p += 40;
+        break;
 
-            case 32+8:    /* RF4_BR_ACID */
-            if (borg_skill[BI_IACID]) break;
-            z = (hp / 3);
-            /* max damage */
-            if (z > 1600)
-                z = 1600;
-            if (borg_skill[BI_RACID]) z = (z + 2) / 3;
-            if (my_oppose_acid) z = (z + 2) / 3;
-            /* if looking at full damage, things that are just annoying */
-            /* do not count.*/
-            /* Add fear for the effect */
-                p += 40;
-            break;
+        case 32+9:    /* RF4_BR_ELEC */
+        if (borg_skill[BI_IELEC]) break;
+        z = (hp / 3);
+        /* max damage */
+        if (z > 1600)
+            z = 1600;
+        if (borg_skill[BI_RELEC]) z = (z + 2) / 3;
+        if (my_oppose_elec) z = (z + 2) / 3;
+        /* if looking at full damage, things that are just annoying */
+        /* do not count.*/
+        /* Add fear for the effect */
+            p += 20;
+        break;
 
-            case 32+9:    /* RF4_BR_ELEC */
-            if (borg_skill[BI_IELEC]) break;
-            z = (hp / 3);
-            /* max damage */
-            if (z > 1600)
-                z = 1600;
-            if (borg_skill[BI_RELEC]) z = (z + 2) / 3;
-            if (my_oppose_elec) z = (z + 2) / 3;
-            /* if looking at full damage, things that are just annoying */
-            /* do not count.*/
-            /* Add fear for the effect */
-                p += 20;
-            break;
+        case 32+10:    /* RF4_BR_FIRE */
+        if (borg_skill[BI_IFIRE]) break;
+        z = (hp / 3);
+        /* max damage */
+        if (z > 1600)
+            z = 1600;
+        if (borg_skill[BI_RFIRE]) z = (z + 2) / 3;
+        if (my_oppose_fire) z = (z + 2) / 3;
+        /* if looking at full damage, things that are just annoying */
+        /* do not count. */
+        /* Add fear for the effect */
+            p += 40;
+        break;
 
-            case 32+10:    /* RF4_BR_FIRE */
-            if (borg_skill[BI_IFIRE]) break;
-            z = (hp / 3);
-            /* max damage */
-            if (z > 1600)
-                z = 1600;
-            if (borg_skill[BI_RFIRE]) z = (z + 2) / 3;
-            if (my_oppose_fire) z = (z + 2) / 3;
-            /* if looking at full damage, things that are just annoying */
-            /* do not count. */
-            /* Add fear for the effect */
-                p += 40;
-            break;
+        case 32+11:    /* RF4_BR_COLD */
+        if (borg_skill[BI_ICOLD]) break;
+        z = (hp / 3);
+        /* max damage */
+        if (z > 1600)
+            z = 1600;
+        if (borg_skill[BI_RCOLD]) z = (z + 2) / 3;
+        if (my_oppose_cold) z = (z + 2) / 3;
+        /* if looking at full damage, things that are just annoying */
+        /* do not count. */
+        /* Add fear for the effect */
+            p += 20;
+        break;
 
-            case 32+11:    /* RF4_BR_COLD */
-            if (borg_skill[BI_ICOLD]) break;
-            z = (hp / 3);
-            /* max damage */
-            if (z > 1600)
-                z = 1600;
-            if (borg_skill[BI_RCOLD]) z = (z + 2) / 3;
-            if (my_oppose_cold) z = (z + 2) / 3;
-            /* if looking at full damage, things that are just annoying */
-            /* do not count. */
-            /* Add fear for the effect */
-                p += 20;
-            break;
+        case 32+12:    /* RF4_BR_POIS */
+        z = (hp / 3);
+        /* max damage */
+        if (z > 800)
+            z = 800;
+        if (borg_skill[BI_RPOIS]) z = (z + 2) / 3;
+        if (my_oppose_pois) z = (z + 2) / 3;
+        if (my_oppose_pois) break;
+        if (borg_skill[BI_RPOIS]) break;
+        /* if looking at full damage, things that are just annoying */
+        /* do not count. */
+        /* Add fear for the effect */
+            p += 20;
+        break;
 
-            case 32+12:    /* RF4_BR_POIS */
-            z = (hp / 3);
-            /* max damage */
-            if (z > 800)
-                z = 800;
-            if (borg_skill[BI_RPOIS]) z = (z + 2) / 3;
-            if (my_oppose_pois) z = (z + 2) / 3;
-            if (my_oppose_pois) break;
-            if (borg_skill[BI_RPOIS]) break;
-            /* if looking at full damage, things that are just annoying */
-            /* do not count. */
-            /* Add fear for the effect */
-                p += 20;
+        case 32+13:    /* RF4_BR_NETH */
+        z = (hp / 6);
+        /* max damage */
+        if (z > 350)
+            z = 550;
+        if (borg_skill[BI_RNTHR])
+        {
+            z = (z*6)/9;
             break;
+        }
+        /* Add fear for the effect */
+            p += 125;
+        break;
 
-            case 32+13:    /* RF4_BR_NETH */
-            z = (hp / 6);
-            /* max damage */
-            if (z > 350)
-                z = 550;
-            if (borg_skill[BI_RNTHR])
-            {
-                z = (z*6)/9;
-                break;
-            }
-            /* Add fear for the effect */
-                p += 125;
+        case 32+14:    /* RF4_BR_LIGHT */
+        z = (hp / 6);
+        /* max damage */
+        if (z > 400)
+            z = 400;
+        if (borg_skill[BI_RLITE])
+        {
+            z = (z*2)/3;
             break;
-
-            case 32+14:    /* RF4_BR_LIGHT */
-            z = (hp / 6);
-            /* max damage */
-            if (z > 400)
-                z = 400;
-            if (borg_skill[BI_RLITE])
-            {
-                z = (z*2)/3;
-                break;
-            }
-            if (borg_skill[BI_RBLIND]) break;
-            p += 20;
+        }
+        if (borg_skill[BI_RBLIND]) break;
+        p += 20;
 			if (borg_class == CLASS_MAGE) p +=20;
-            break;
+        break;
 
-            case 32+15:    /* RF4_BR_DARK */
-            z = (hp / 6);
-            /* max damage */
-            if (z > 400)
-                z = 400;
-            if (borg_skill[BI_RDARK]) z = (z*2)/ 3;
-            if (borg_skill[BI_RDARK]) break;
-            if (borg_skill[BI_RBLIND]) break;
-            p += 20;
+        case 32+15:    /* RF4_BR_DARK */
+        z = (hp / 6);
+        /* max damage */
+        if (z > 400)
+            z = 400;
+        if (borg_skill[BI_RDARK]) z = (z*2)/ 3;
+        if (borg_skill[BI_RDARK]) break;
+        if (borg_skill[BI_RBLIND]) break;
+        p += 20;
 			if (borg_class == CLASS_MAGE) p +=20;
-            break;
+        break;
 
-            case 32+16:    /* RF4_BR_CONF */
-            z = (hp / 6);
-            /* max damage */
-            if (z > 400)
-                z = 400;
-            if (borg_skill[BI_RCONF]) z = z / 2;
-            if (borg_skill[BI_RCONF]) break;
-            /* if looking at full damage, things that are just annoying */
-            /* do not count. */
-            /* Add fear for the effect */
-                p += 300;
+        case 32+16:    /* RF4_BR_CONF */
+        z = (hp / 6);
+        /* max damage */
+        if (z > 400)
+            z = 400;
+        if (borg_skill[BI_RCONF]) z = z / 2;
+        if (borg_skill[BI_RCONF]) break;
+        /* if looking at full damage, things that are just annoying */
+        /* do not count. */
+        /* Add fear for the effect */
+            p += 300;
 			if (borg_class == CLASS_MAGE) p +=200;
-            break;
-
-            case 32+17:    /* RF4_BR_SOUN */
-            z = (hp / 6);
-            /* max damage */
-            if (z > 500)
-                z = 500;
-            if (borg_skill[BI_RSND]) z = (z*5)/9;
-            if (borg_skill[BI_RSND]) break;
-            /* if already stunned be REALLY nervous dangerousabout this */
-            if (borg_skill[BI_ISSTUN])
-                p += 500;
-            if (borg_skill[BI_ISHEAVYSTUN])
-                p += 1000;
-            /* if looking at full damage, things that are just annoying */
-            /* do not count. */
-            /* Add fear for the effect */
-                p += 50;
-            break;
-
-            case 32+18:    /* RF4_BR_CHAO */
-            z = (hp / 6);
-            /* max damage */
-            if (z > 500)
-                z = 500;
-            if (borg_skill[BI_RKAOS]) z = (z*6)/9;
-            /* Add fear for the effect */
-                p += 100;
-            if (borg_skill[BI_RKAOS]) break;
-            p += 200;
-            break;
+        break;
 
-            case 32+19:    /* RF4_BR_DISE */
-            z = (hp / 6);
-            /* max damage */
-            if (z > 500)
-                z = 500;
-            if (borg_skill[BI_RDIS]) z = (z*6)/10;
-            if (borg_skill[BI_RDIS]) break;
+        case 32+17:    /* RF4_BR_SOUN */
+        z = (hp / 6);
+        /* max damage */
+        if (z > 500)
+            z = 500;
+        if (borg_skill[BI_RSND]) z = (z*5)/9;
+        if (borg_skill[BI_RSND]) break;
+        /* if already stunned be REALLY nervous dangerousabout this */
+        if (borg_skill[BI_ISSTUN])
             p += 500;
-            break;
+        if (borg_skill[BI_ISHEAVYSTUN])
+            p += 1000;
+        /* if looking at full damage, things that are just annoying */
+        /* do not count. */
+        /* Add fear for the effect */
+            p += 50;
+        break;
 
-            case 32+20:    /* RF4_BR_NEXU */
-            z = (hp / 3);
-            /* max damage */
-            if (z > 400)
-                z = 400;
-            if (borg_skill[BI_RNXUS]) z = (z*6)/10;
-            if (borg_skill[BI_RNXUS]) break;
-            /* if looking at full damage, things that are just annoying */
-            /* do not count. */
-            /* Add fear for the effect */
-                p += 100;
-            break;
+        case 32+18:    /* RF4_BR_CHAO */
+        z = (hp / 6);
+        /* max damage */
+        if (z > 500)
+            z = 500;
+        if (borg_skill[BI_RKAOS]) z = (z*6)/9;
+        /* Add fear for the effect */
+            p += 100;
+        if (borg_skill[BI_RKAOS]) break;
+        p += 200;
+        break;
 
-            case 32+21:    /* RF4_BR_TIME */
-            z = (hp / 3);
-            /* max damage */
-            if (z > 150)
-                z = 150;
-            /* if looking at full damage, things that are just annoying */
-            /* do not count. */
-            /* Add fear for the effect */
-                p += 250;
-            break;
+        case 32+19:    /* RF4_BR_DISE */
+        z = (hp / 6);
+        /* max damage */
+        if (z > 500)
+            z = 500;
+        if (borg_skill[BI_RDIS]) z = (z*6)/10;
+        if (borg_skill[BI_RDIS]) break;
+        p += 500;
+        break;
 
-            case 32+22:    /* RF4_BR_INER */
-            z = (hp / 6);
-            /* max damage */
-            if (z > 200)
-                z = 200;
-            /* if looking at full damage, things that are just annoying */
-            /* do not count. */
-            /* Add fear for the effect */
-                p += 100;
-            break;
+        case 32+20:    /* RF4_BR_NEXU */
+        z = (hp / 3);
+        /* max damage */
+        if (z > 400)
+            z = 400;
+        if (borg_skill[BI_RNXUS]) z = (z*6)/10;
+        if (borg_skill[BI_RNXUS]) break;
+        /* if looking at full damage, things that are just annoying */
+        /* do not count. */
+        /* Add fear for the effect */
+            p += 100;
+        break;
 
-            case 32+23:    /* RF4_BR_GRAV */
-            z = (hp / 3);
-            /* max damage */
-            if (z > 200)
-                z = 200;
-            /* if looking at full damage, things that are just annoying */
-            /* do not count. */
-            /* Add fear for the effect */
-                p += 100;
-            if (borg_skill[BI_RSND]) break;
-            /* if already stunned be REALLY nervous about this */
-            if (borg_skill[BI_ISSTUN])
-                p += 500;
-            if (borg_skill[BI_ISHEAVYSTUN])
-                p += 1000;
-            break;
+        case 32+21:    /* RF4_BR_TIME */
+        z = (hp / 3);
+        /* max damage */
+        if (z > 150)
+            z = 150;
+        /* if looking at full damage, things that are just annoying */
+        /* do not count. */
+        /* Add fear for the effect */
+            p += 250;
+        break;
 
-            case 32+24:    /* RF4_BR_SHAR */
-            z = (hp / 6);
-            /* max damage */
-            if (z > 500)
-                z = 500;
-            if (borg_skill[BI_RSHRD]) z = (z*6)/9;
-            if (borg_skill[BI_RSHRD]) break;
-            /* if looking at full damage, things that are just annoying */
-            /* do not count. */
-            /* Add fear for the effect */
-                p += 50;
-            break;
+        case 32+22:    /* RF4_BR_INER */
+        z = (hp / 6);
+        /* max damage */
+        if (z > 200)
+            z = 200;
+        /* if looking at full damage, things that are just annoying */
+        /* do not count. */
+        /* Add fear for the effect */
+            p += 100;
+        break;
 
-            case 32+25:    /* RF4_BR_PLAS */
-            z = (hp / 6);
-            /* max damage */
-            if (z > 150)
-                z = 150;
-            if (borg_skill[BI_RSND]) break;
-            /* Pump this up if you have goi so that the borg is sure */
-            /* to be made nervous */
+        case 32+23:    /* RF4_BR_GRAV */
+        z = (hp / 3);
+        /* max damage */
+        if (z > 200)
+            z = 200;
+        /* if looking at full damage, things that are just annoying */
+        /* do not count. */
+        /* Add fear for the effect */
             p += 100;
-            /* if already stunned be REALLY nervous about this */
-            if (borg_skill[BI_ISSTUN])
-                p += 500;
-            if (borg_skill[BI_ISHEAVYSTUN])
-                p += 1000;
-            break;
+        if (borg_skill[BI_RSND]) break;
+        /* if already stunned be REALLY nervous about this */
+        if (borg_skill[BI_ISSTUN])
+            p += 500;
+        if (borg_skill[BI_ISHEAVYSTUN])
+            p += 1000;
+        break;
 
-            case 32+26:    /* RF4_BR_WALL */
-            z = (hp / 6);
-            /* max damage */
-            if (z > 200)
-                z = 200;
-            if (borg_skill[BI_RSND]) break;
-            /* if already stunned be REALLY nervous about this */
-            if (borg_skill[BI_ISSTUN])
-                p += 100;
-            if (borg_skill[BI_ISHEAVYSTUN])
-                p += 500;
-            /* Add fear for the effect */
-                p += 50;
-            break;
+        case 32+24:    /* RF4_BR_SHAR */
+        z = (hp / 6);
+        /* max damage */
+        if (z > 500)
+            z = 500;
+        if (borg_skill[BI_RSHRD]) z = (z*6)/9;
+        if (borg_skill[BI_RSHRD]) break;
+        /* if looking at full damage, things that are just annoying */
+        /* do not count. */
+        /* Add fear for the effect */
+            p += 50;
+        break;
 
-            case 32+27:    /* RF4_BR_MANA */
-            /* XXX XXX XXX */
-            break;
+        case 32+25:    /* RF4_BR_PLAS */
+        z = (hp / 6);
+        /* max damage */
+        if (z > 150)
+            z = 150;
+        if (borg_skill[BI_RSND]) break;
+        /* Pump this up if you have goi so that the borg is sure */
+        /* to be made nervous */
+        p += 100;
+        /* if already stunned be REALLY nervous about this */
+        if (borg_skill[BI_ISSTUN])
+            p += 500;
+        if (borg_skill[BI_ISHEAVYSTUN])
+            p += 1000;
+        break;
 
-            case 32+28:    /* RF4_XXX5X4 */
-            break;
+        case 32+26:    /* RF4_BR_WALL */
+        z = (hp / 6);
+        /* max damage */
+        if (z > 200)
+            z = 200;
+        if (borg_skill[BI_RSND]) break;
+        /* if already stunned be REALLY nervous about this */
+        if (borg_skill[BI_ISSTUN])
+            p += 100;
+        if (borg_skill[BI_ISHEAVYSTUN])
+            p += 500;
+        /* Add fear for the effect */
+            p += 50;
+        break;
 
-            case 32+29:    /* RF4_XXX6X4 */
-            break;
+        case 32+27:    /* RF4_BR_MANA */
+        /* XXX XXX XXX */
+        break;
 
-            case 32+30:    /* RF4_XXX7X4 */
-            break;
+        case 32+28:    /* RF4_XXX5X4 */
+        break;
 
-            case 32+31:    /* RF4_BOULDER */
-            z = (1 + lev / 7) * 12 / 2;
-            break;
+        case 32+29:    /* RF4_XXX6X4 */
+        break;
 
-            case 64+0:    /* RF5_BA_ACID */
-            if (borg_skill[BI_IACID]) break;
-            z = (lev * 3) / 2 + 15;
-            if (borg_skill[BI_RACID]) z = (z + 2) / 3;
-            if (my_oppose_acid) z = (z + 2) / 3;
-            /* if looking at full damage, things that are just annoying */
-            /* do not count. */
-            /* Add fear for the effect */
-                p += 40;
-            break;
+        case 32+30:    /* RF4_XXX7X4 */
+        break;
 
-            case 64+1:    /* RF5_BA_ELEC */
-            if (borg_skill[BI_IELEC]) break;
-            z = (lev * 3) / 2 + 8;
-            if (borg_skill[BI_RELEC]) z = (z + 2) / 3;
-            if (my_oppose_elec) z = (z + 2) / 3;
-            /* if looking at full damage, things that are just annoying */
-            /* do not count. */
-            /* Add fear for the effect */
-                p += 20;
-            break;
+        case 32+31:    /* RF4_BOULDER */
+        z = (1 + lev / 7) * 12 / 2;
+        break;
 
-            case 64+2:    /* RF5_BA_FIRE */
-            if (borg_skill[BI_IFIRE]) break;
-            z = (lev * 7) / 2 + 10;
-            if (borg_skill[BI_RFIRE]) z = (z + 2) / 3;
-            if (my_oppose_fire) z = (z + 2) / 3;
-            /* if looking at full damage, things that are just annoying */
-            /* do not count. */
-            /* Add fear for the effect */
-                p += 40;
-            break;
+        case 64+0:    /* RF5_BA_ACID */
+        if (borg_skill[BI_IACID]) break;
+        z = (lev * 3) / 2 + 15;
+        if (borg_skill[BI_RACID]) z = (z + 2) / 3;
+        if (my_oppose_acid) z = (z + 2) / 3;
+        /* if looking at full damage, things that are just annoying */
+        /* do not count. */
+        /* Add fear for the effect */
+            p += 40;
+        break;
 
-            case 64+3:    /* RF5_BA_COLD */
-            if (borg_skill[BI_ICOLD]) break;
-            z = (lev * 3) / 2 + 10;
-            if (borg_skill[BI_RCOLD]) z = (z + 2) / 3;
-            if (my_oppose_cold) z = (z + 2) / 3;
-            /* if looking at full damage, things that are just annoying */
-            /* do not count. */
-            /* Add fear for the effect */
-                p += 20;
-            break;
+        case 64+1:    /* RF5_BA_ELEC */
+        if (borg_skill[BI_IELEC]) break;
+        z = (lev * 3) / 2 + 8;
+        if (borg_skill[BI_RELEC]) z = (z + 2) / 3;
+        if (my_oppose_elec) z = (z + 2) / 3;
+        /* if looking at full damage, things that are just annoying */
+        /* do not count. */
+        /* Add fear for the effect */
+            p += 20;
+        break;
 
-            case 64+4:    /* RF5_BA_POIS */
-            z = (12 * 2);
-            if (borg_skill[BI_RPOIS]) z = (z + 2) / 3;
-            if (my_oppose_pois) z = (z + 2) / 3;
-            if (my_oppose_pois) break;
-            if (borg_skill[BI_RPOIS]) break;
-            /* if looking at full damage, things that are just annoying */
-            /* do not count. */
-            /* Add fear for the effect */
-                p += 20;
-            break;
+        case 64+2:    /* RF5_BA_FIRE */
+        if (borg_skill[BI_IFIRE]) break;
+        z = (lev * 7) / 2 + 10;
+        if (borg_skill[BI_RFIRE]) z = (z + 2) / 3;
+        if (my_oppose_fire) z = (z + 2) / 3;
+        /* if looking at full damage, things that are just annoying */
+        /* do not count. */
+        /* Add fear for the effect */
+            p += 40;
+        break;
 
-            case 64+5:    /* RF5_BA_NETH */
-            z = (50 +50 + (10 * 10) + lev);
-            if (borg_skill[BI_RNTHR]) z = (z*6)/8;
-            if (borg_skill[BI_RNTHR]) break;
-            /* if looking at full damage, things that are just annoying */
-            /* do not count. */
-            /* Add fear for the effect */
-                p += 250;
-            break;
+        case 64+3:    /* RF5_BA_COLD */
+        if (borg_skill[BI_ICOLD]) break;
+        z = (lev * 3) / 2 + 10;
+        if (borg_skill[BI_RCOLD]) z = (z + 2) / 3;
+        if (my_oppose_cold) z = (z + 2) / 3;
+        /* if looking at full damage, things that are just annoying */
+        /* do not count. */
+        /* Add fear for the effect */
+            p += 20;
+        break;
 
-            case 64+6:    /* RF5_BA_WATE */
-            z = ((lev * 5) / 2) + 50;
-            if (borg_skill[BI_RSND]) break;
-            /* if already stunned be REALLY nervous about this */
-            if (borg_skill[BI_ISSTUN])
-                p += 500;
-            if (borg_skill[BI_ISHEAVYSTUN])
-                p += 1000;
-            if (borg_skill[BI_RCONF]) break;
-            /* if looking at full damage, things that are just annoying */
-            /* do not count. */
-            /* Add fear for the effect */
-                p += 50;
-			if (borg_class == CLASS_MAGE) p +=20;
-            break;
+        case 64+4:    /* RF5_BA_POIS */
+        z = (12 * 2);
+        if (borg_skill[BI_RPOIS]) z = (z + 2) / 3;
+        if (my_oppose_pois) z = (z + 2) / 3;
+        if (my_oppose_pois) break;
+        if (borg_skill[BI_RPOIS]) break;
+        /* if looking at full damage, things that are just annoying */
+        /* do not count. */
+        /* Add fear for the effect */
+            p += 20;
+        break;
 
-            case 64+7:    /* RF5_BA_MANA */
-            z = ((lev * 5) + 150);
-            /* Add fear for the effect */
-                p += 50;
-            break;
+        case 64+5:    /* RF5_BA_NETH */
+        z = (50 +50 + (10 * 10) + lev);
+        if (borg_skill[BI_RNTHR]) z = (z*6)/8;
+        if (borg_skill[BI_RNTHR]) break;
+        /* if looking at full damage, things that are just annoying */
+        /* do not count. */
+        /* Add fear for the effect */
+            p += 250;
+        break;
 
-            case 64+8:    /* RF5_BA_DARK */
-            z = (((lev * 5)) + (50));
-            if (borg_skill[BI_RDARK]) z = (z*6)/9;
-            if (borg_skill[BI_RDARK]) break;
-            if (borg_skill[BI_RBLIND]) break;
-            /* if looking at full damage, things that are just annoying */
-            /* do not count. */
-            /* Add fear for the effect */
-                p += 20;
+        case 64+6:    /* RF5_BA_WATE */
+        z = ((lev * 5) / 2) + 50;
+        if (borg_skill[BI_RSND]) break;
+        /* if already stunned be REALLY nervous about this */
+        if (borg_skill[BI_ISSTUN])
+            p += 500;
+        if (borg_skill[BI_ISHEAVYSTUN])
+            p += 1000;
+        if (borg_skill[BI_RCONF]) break;
+        /* if looking at full damage, things that are just annoying */
+        /* do not count. */
+        /* Add fear for the effect */
+            p += 50;
 			if (borg_class == CLASS_MAGE) p +=20;
-            break;
-
-            case 64+9:    /* RF5_DRAIN_MANA */
-            if (borg_skill[BI_MAXSP]) p += 10;
-            break;
+        break;
 
-            case 64+10:    /* RF5_MIND_BLAST */
-            if (borg_skill[BI_SAV] < 100)
-                z = 20;
-            break;
+        case 64+7:    /* RF5_BA_MANA */
+        z = ((lev * 5) + 150);
+        /* Add fear for the effect */
+            p += 50;
+        break;
 
-            case 64+11:    /* RF5_BRAIN_SMASH */
-            z = (12 * 15);
-            p += 200 - 2 * borg_skill[BI_SAV];
-            if (p < 0) p =0;
-            break;
+        case 64+8:    /* RF5_BA_DARK */
+        z = (((lev * 5)) + (50));
+        if (borg_skill[BI_RDARK]) z = (z*6)/9;
+        if (borg_skill[BI_RDARK]) break;
+        if (borg_skill[BI_RBLIND]) break;
+        /* if looking at full damage, things that are just annoying */
+        /* do not count. */
+        /* Add fear for the effect */
+            p += 20;
+			if (borg_class == CLASS_MAGE) p +=20;
+        break;
 
-            case 64+12:    /* RF5_CAUSE_1 */
-            if (borg_skill[BI_SAV] >= 100) break;
-            z = (3 * 8);
-            /* if looking at full damage, things that are just annoying */
-            /* do not count. */
-            /* Add fear for the effect */
-                /* reduce by % chance of save  (add 20% for fudge) */
-                z = z * (120 - borg_skill[BI_SAV]) / 100;
-            break;
+        case 64+9:    /* RF5_DRAIN_MANA */
+        if (borg_skill[BI_MAXSP]) p += 10;
+        break;
 
-            case 64+13:    /* RF5_CAUSE_2 */
-            if (borg_skill[BI_SAV] >= 100) break;
-            z = (8 * 8);
-            /* if looking at full damage, things that are just annoying */
-            /* do not count. */
-            /* Add fear for the effect */
-                /* reduce by % chance of save  (add 20% for fudge) */
-                z = z * (120 - borg_skill[BI_SAV]) / 100;
-            break;
+        case 64+10:    /* RF5_MIND_BLAST */
+        if (borg_skill[BI_SAV] < 100)
+            z = 20;
+        break;
 
-            case 64+14:    /* RF5_CAUSE_3 */
-            if (borg_skill[BI_SAV] >= 100) break;
-            z = (10 * 15);
-            /* if looking at full damage, things that are just annoying */
-            /* do not count. */
-            /* Add fear for the effect */
-                /* reduce by % chance of save  (add 20% for fudge) */
-                z = z * (120 - borg_skill[BI_SAV]) / 100;
-            break;
+        case 64+11:    /* RF5_BRAIN_SMASH */
+        z = (12 * 15);
+        p += 200 - 2 * borg_skill[BI_SAV];
+        if (p < 0) p =0;
+        break;
 
-            case 64+15:    /* RF5_CAUSE_4 */
-            if (borg_skill[BI_SAV] >= 100) break;
-            z = (15 * 15);
-            /* if looking at full damage, things that are just annoying */
-            /* do not count. */
-            /* Add fear for the effect */
-                p += 20;
-            /* if looking at full damage, things that are just annoying */
-            /* do not count. */
-            /* Add fear for the effect */
-                /* reduce by % chance of save  (add 40% for fudge) */
-                z = z * (120 - borg_skill[BI_SAV]) / 100;
-            break;
+        case 64+12:    /* RF5_CAUSE_1 */
+        if (borg_skill[BI_SAV] >= 100) break;
+        z = (3 * 8);
+        /* if looking at full damage, things that are just annoying */
+        /* do not count. */
+        /* Add fear for the effect */
+            /* reduce by % chance of save  (add 20% for fudge) */
+            z = z * (120 - borg_skill[BI_SAV]) / 100;
+        break;
 
-            case 64+16:    /* RF5_BO_ACID */
-            if (borg_skill[BI_IACID]) break;
-            z = ((7 * 8) + (lev / 3));
-            if (borg_skill[BI_RACID]) z = (z + 2) / 3;
-            if (my_oppose_acid) z = (z + 2) / 3;
-            /* if looking at full damage, things that are just annoying */
-            /* do not count. */
-            /* Add fear for the effect */
-                p += 40;
-            break;
+        case 64+13:    /* RF5_CAUSE_2 */
+        if (borg_skill[BI_SAV] >= 100) break;
+        z = (8 * 8);
+        /* if looking at full damage, things that are just annoying */
+        /* do not count. */
+        /* Add fear for the effect */
+            /* reduce by % chance of save  (add 20% for fudge) */
+            z = z * (120 - borg_skill[BI_SAV]) / 100;
+        break;
 
-            case 64+17:    /* RF5_BO_ELEC */
-            if (borg_skill[BI_IELEC]) break;
-            z = ((4 * 8) + (lev / 3));
-            if (borg_skill[BI_RELEC]) z = (z + 2) / 3;
-            if (my_oppose_elec) z = (z + 2) / 3;
-            /* if looking at full damage, things that are just annoying */
-            /* do not count. */
-            /* Add fear for the effect */
-                p += 20;
-            break;
+        case 64+14:    /* RF5_CAUSE_3 */
+        if (borg_skill[BI_SAV] >= 100) break;
+        z = (10 * 15);
+        /* if looking at full damage, things that are just annoying */
+        /* do not count. */
+        /* Add fear for the effect */
+            /* reduce by % chance of save  (add 20% for fudge) */
+            z = z * (120 - borg_skill[BI_SAV]) / 100;
+        break;
 
-            case 64+18:    /* RF5_BO_FIRE */
-            if (borg_skill[BI_IFIRE]) break;
-            z = ((9 * 8) + (lev / 3));
-            if (borg_skill[BI_RFIRE]) z = (z + 2) / 3;
-            if (my_oppose_fire) z = (z + 2) / 3;
-            /* if looking at full damage, things that are just annoying */
-            /* do not count. */
-            /* Add fear for the effect */
-                p += 40;
-            break;
+        case 64+15:    /* RF5_CAUSE_4 */
+        if (borg_skill[BI_SAV] >= 100) break;
+        z = (15 * 15);
+        /* if looking at full damage, things that are just annoying */
+        /* do not count. */
+        /* Add fear for the effect */
+            p += 20;
+        /* if looking at full damage, things that are just annoying */
+        /* do not count. */
+        /* Add fear for the effect */
+            /* reduce by % chance of save  (add 40% for fudge) */
+            z = z * (120 - borg_skill[BI_SAV]) / 100;
+        break;
 
-            case 64+19:    /* RF5_BO_COLD */
-            if (borg_skill[BI_ICOLD]) break;
-            z = ((6 * 8) + (lev / 3));
-            if (borg_skill[BI_RCOLD]) z = (z + 2) / 3;
-            if (my_oppose_cold) z = (z + 2) / 3;
-            /* if looking at full damage, things that are just annoying */
-            /* do not count. */
-            /* Add fear for the effect */
-                p += 20;
-            break;
+        case 64+16:    /* RF5_BO_ACID */
+        if (borg_skill[BI_IACID]) break;
+        z = ((7 * 8) + (lev / 3));
+        if (borg_skill[BI_RACID]) z = (z + 2) / 3;
+        if (my_oppose_acid) z = (z + 2) / 3;
+        /* if looking at full damage, things that are just annoying */
+        /* do not count. */
+        /* Add fear for the effect */
+            p += 40;
+        break;
 
-            case 64+20:    /* RF5_BO_POIS */
-            /* XXX XXX XXX */
-            break;
+        case 64+17:    /* RF5_BO_ELEC */
+        if (borg_skill[BI_IELEC]) break;
+        z = ((4 * 8) + (lev / 3));
+        if (borg_skill[BI_RELEC]) z = (z + 2) / 3;
+        if (my_oppose_elec) z = (z + 2) / 3;
+        /* if looking at full damage, things that are just annoying */
+        /* do not count. */
+        /* Add fear for the effect */
+            p += 20;
+        break;
 
-            case 64+21:    /* RF5_BO_NETH */
-            z = (50 + 30 + (5 * 5) + (lev * 3) / 2);
-            if (borg_skill[BI_RNTHR]) z = (z*6)/8;
-            if (borg_skill[BI_RNTHR]) break;
-            /* if looking at full damage, things that are just annoying */
-            /* do not count. */
-            /* Add fear for the effect */
-                p += 200;
-            break;
+        case 64+18:    /* RF5_BO_FIRE */
+        if (borg_skill[BI_IFIRE]) break;
+        z = ((9 * 8) + (lev / 3));
+        if (borg_skill[BI_RFIRE]) z = (z + 2) / 3;
+        if (my_oppose_fire) z = (z + 2) / 3;
+        /* if looking at full damage, things that are just annoying */
+        /* do not count. */
+        /* Add fear for the effect */
+            p += 40;
+        break;
 
-            case 64+22:    /* RF5_BO_WATE */
-            z = ((10 * 10) + (lev));
-            if (borg_skill[BI_RSND]) break;
-            /* if already stunned be REALLY nervous about this */
-            if (borg_skill[BI_ISSTUN])
-                p += 500;
-            if (borg_skill[BI_ISHEAVYSTUN])
-                p += 1000;
-            if (borg_skill[BI_RCONF]) break;
-            /* if looking at full damage, things that are just annoying */
-            /* do not count. */
-            /* Add fear for the effect */
-                p += 20;
+        case 64+19:    /* RF5_BO_COLD */
+        if (borg_skill[BI_ICOLD]) break;
+        z = ((6 * 8) + (lev / 3));
+        if (borg_skill[BI_RCOLD]) z = (z + 2) / 3;
+        if (my_oppose_cold) z = (z + 2) / 3;
+        /* if looking at full damage, things that are just annoying */
+        /* do not count. */
+        /* Add fear for the effect */
+            p += 20;
+        break;
+
+        case 64+20:    /* RF5_BO_POIS */
+        /* XXX XXX XXX */
+        break;
+
+        case 64+21:    /* RF5_BO_NETH */
+        z = (50 + 30 + (5 * 5) + (lev * 3) / 2);
+        if (borg_skill[BI_RNTHR]) z = (z*6)/8;
+        if (borg_skill[BI_RNTHR]) break;
+        /* if looking at full damage, things that are just annoying */
+        /* do not count. */
+        /* Add fear for the effect */
+            p += 200;
+        break;
+
+        case 64+22:    /* RF5_BO_WATE */
+        z = ((10 * 10) + (lev));
+        if (borg_skill[BI_RSND]) break;
+        /* if already stunned be REALLY nervous about this */
+        if (borg_skill[BI_ISSTUN])
+            p += 500;
+        if (borg_skill[BI_ISHEAVYSTUN])
+            p += 1000;
+        if (borg_skill[BI_RCONF]) break;
+        /* if looking at full damage, things that are just annoying */
+        /* do not count. */
+        /* Add fear for the effect */
+            p += 20;
 			if (borg_class == CLASS_MAGE) p +=20;
-            break;
+        break;
 
-            case 64+23:    /* RF5_BO_MANA */
-            z = ((lev * 7) / 2) + 50;
-            /* Add fear for the effect */
-                p += 50;
-            break;
+        case 64+23:    /* RF5_BO_MANA */
+        z = ((lev * 7) / 2) + 50;
+        /* Add fear for the effect */
+            p += 50;
+        break;
 
-            case 64+24:    /* RF5_BO_PLAS */
-            z = (10 + (8 * 7) + (lev));
-            if (borg_skill[BI_RSND]) break;
-            /* if already stunned be REALLY nervous about this */
-            if (borg_skill[BI_ISSTUN])
-                p += 500;
-            if (borg_skill[BI_ISHEAVYSTUN])
-                p += 1000;
-            break;
+        case 64+24:    /* RF5_BO_PLAS */
+        z = (10 + (8 * 7) + (lev));
+        if (borg_skill[BI_RSND]) break;
+        /* if already stunned be REALLY nervous about this */
+        if (borg_skill[BI_ISSTUN])
+            p += 500;
+        if (borg_skill[BI_ISHEAVYSTUN])
+            p += 1000;
+        break;
 
-            case 64+25:    /* RF5_BO_ICEE */
-            z = ((6 * 6) + (lev));
-            /* if looking at full damage, things that are just annoying */
-            /* do not count. */
-            /* Add fear for the effect */
-                p += 20;
-            if (borg_skill[BI_RSND]) break;
-            /* if already stunned be REALLY nervous about this */
-            if (borg_skill[BI_ISSTUN])
-                p += 50;
-            if (borg_skill[BI_ISHEAVYSTUN])
-                p += 1000;
-            break;
+        case 64+25:    /* RF5_BO_ICEE */
+        z = ((6 * 6) + (lev));
+        /* if looking at full damage, things that are just annoying */
+        /* do not count. */
+        /* Add fear for the effect */
+            p += 20;
+        if (borg_skill[BI_RSND]) break;
+        /* if already stunned be REALLY nervous about this */
+        if (borg_skill[BI_ISSTUN])
+            p += 50;
+        if (borg_skill[BI_ISHEAVYSTUN])
+            p += 1000;
+        break;
 
-            case 64+26:    /* RF5_MISSILE */
-            z = ((2 * 6) + (lev / 3));
-            break;
+        case 64+26:    /* RF5_MISSILE */
+        z = ((2 * 6) + (lev / 3));
+        break;
 
-            case 64+27:    /* RF5_SCARE */
-            if (borg_skill[BI_SAV] >= 100) break;
-            /* if looking at full damage, things that are just annoying */
-            /* do not count. */
-            /* Add fear for the effect */
-                p += 10;
-            break;
+        case 64+27:    /* RF5_SCARE */
+        if (borg_skill[BI_SAV] >= 100) break;
+        /* if looking at full damage, things that are just annoying */
+        /* do not count. */
+        /* Add fear for the effect */
+            p += 10;
+        break;
 
-            case 64+28:    /* RF5_BLIND */
-            if (borg_skill[BI_SAV] >= 100) break;
-            /* if looking at full damage, things that are just annoying */
-            /* do not count. */
-            /* Add fear for the effect */
-                p += 10;
-            break;
+        case 64+28:    /* RF5_BLIND */
+        if (borg_skill[BI_SAV] >= 100) break;
+        /* if looking at full damage, things that are just annoying */
+        /* do not count. */
+        /* Add fear for the effect */
+            p += 10;
+        break;
 
-            case 64+29:    /* RF5_CONF */
-            if (borg_skill[BI_SAV] >= 100) break;
-            /* if looking at full damage, things that are just annoying */
-            /* do not count. */
-            /* Add fear for the effect */
-                p += 10;
-            break;
+        case 64+29:    /* RF5_CONF */
+        if (borg_skill[BI_SAV] >= 100) break;
+        /* if looking at full damage, things that are just annoying */
+        /* do not count. */
+        /* Add fear for the effect */
+            p += 10;
+        break;
 
-            case 64+30:    /* RF5_SLOW */
-            if (borg_skill[BI_FRACT]) break;
-            if (borg_skill[BI_SAV] >= 100) break;
-            /* if looking at full damage, things that are just annoying */
-            /* do not count. */
-            /* Add fear for the effect */
-                p += 5;
-            break;
+        case 64+30:    /* RF5_SLOW */
+        if (borg_skill[BI_FRACT]) break;
+        if (borg_skill[BI_SAV] >= 100) break;
+        /* if looking at full damage, things that are just annoying */
+        /* do not count. */
+        /* Add fear for the effect */
+            p += 5;
+        break;
 
-            case 64+31:    /* RF5_HOLD */
-            if (borg_skill[BI_FRACT]) break;
-            if (borg_skill[BI_SAV] >= 100) break;
-            p += 150;
-            break;
+        case 64+31:    /* RF5_HOLD */
+        if (borg_skill[BI_FRACT]) break;
+        if (borg_skill[BI_SAV] >= 100) break;
+        p += 150;
+        break;
 
-            case 96+0:    /* RF6_HASTE */
-            /* if looking at full damage, things that are just annoying */
-            /* do not count. */
-            /* Add fear for the effect */
-                p += 10;
-            break;
+        case 96+0:    /* RF6_HASTE */
+        /* if looking at full damage, things that are just annoying */
+        /* do not count. */
+        /* Add fear for the effect */
+            p += 10;
+        break;
 
-            case 96+1:    /* RF6_XXX1X6 */
-            break;
+        case 96+1:    /* RF6_XXX1X6 */
+        break;
 
-            case 96+2:    /* RF6_HEAL */
-            /* if looking at full damage, things that are just annoying */
-            /* do not count. */
-            /* Add fear for the effect */
-                p += 10;
-            break;
+        case 96+2:    /* RF6_HEAL */
+        /* if looking at full damage, things that are just annoying */
+        /* do not count. */
+        /* Add fear for the effect */
+            p += 10;
+        break;
 
-            case 96+3:    /* RF6_XXX2X6 */
-            break;
+        case 96+3:    /* RF6_XXX2X6 */
+        break;
 
-            case 96+4:    /* RF6_BLINK */
-            break;
+        case 96+4:    /* RF6_BLINK */
+        break;
 
-            case 96+5:    /* RF6_TPORT */
-            break;
+        case 96+5:    /* RF6_TPORT */
+        break;
 
-            case 96+6:    /* RF6_XXX3X6 */
-            break;
+        case 96+6:    /* RF6_XXX3X6 */
+        break;
 
-            case 96+7:    /* RF6_XXX4X6 */
-            break;
+        case 96+7:    /* RF6_XXX4X6 */
+        break;
 
-            case 96+8:    /* RF6_TELE_TO */
-            /* if looking at full damage, things that are just annoying */
-            /* do not count. */
-            /* Add fear for the effect */
-                p += 20;
-            break;
+        case 96+8:    /* RF6_TELE_TO */
+        /* if looking at full damage, things that are just annoying */
+        /* do not count. */
+        /* Add fear for the effect */
+            p += 20;
+        break;
 
-            case 96+9:    /* RF6_TELE_AWAY */
-            /* if looking at full damage, things that are just annoying */
-            /* do not count. */
-            /* Add fear for the effect */
-                p += 10;
-            break;
+        case 96+9:    /* RF6_TELE_AWAY */
+        /* if looking at full damage, things that are just annoying */
+        /* do not count. */
+        /* Add fear for the effect */
+            p += 10;
+        break;
 
-            case 96+10:    /* RF6_TELE_LEVEL */
-            if (borg_skill[BI_SAV] >= 100) break;
-            /* if looking at full damage, things that are just annoying */
-            /* do not count. */
-            /* Add fear for the effect */
-                p += 50;
-            break;
+        case 96+10:    /* RF6_TELE_LEVEL */
+        if (borg_skill[BI_SAV] >= 100) break;
+        /* if looking at full damage, things that are just annoying */
+        /* do not count. */
+        /* Add fear for the effect */
+            p += 50;
+        break;
 
-            case 96+11:    /* RF6_XXX5 */
-            break;
+        case 96+11:    /* RF6_XXX5 */
+        break;
 
-            case 96+12:    /* RF6_DARKNESS */
-            /* if looking at full damage, things that are just annoying */
-            /* do not count. */
-            /* Add fear for the effect */
-                p += 5;
-            break;
+        case 96+12:    /* RF6_DARKNESS */
+        /* if looking at full damage, things that are just annoying */
+        /* do not count. */
+        /* Add fear for the effect */
+            p += 5;
+        break;
 
-            case 96+13:    /* RF6_TRAPS */
-            /* if looking at full damage, things that are just annoying */
-            /* do not count. */
-            /* Add fear for the effect */
-                p += 50;
-            break;
+        case 96+13:    /* RF6_TRAPS */
+        /* if looking at full damage, things that are just annoying */
+        /* do not count. */
+        /* Add fear for the effect */
+            p += 50;
+        break;
 
-            case 96+14:    /* RF6_FORGET */
-            if (borg_skill[BI_SAV] >= 100) break;
-            /* if looking at full damage, things that are just annoying */
-            /* do not count. */
-            /* Add fear for the effect */
+        case 96+14:    /* RF6_FORGET */
+        if (borg_skill[BI_SAV] >= 100) break;
+        /* if looking at full damage, things that are just annoying */
+        /* do not count. */
+        /* Add fear for the effect */
+        {
+            /* if you are a spell caster, this is a big issue */
+            if (borg_skill[BI_CURSP] < 15)
             {
-                /* if you are a spell caster, this is a big issue */
-                if (borg_skill[BI_CURSP] < 15)
-                {
-                    p += 500;
-                }
-                else
-                {
-                    p += 30;
-                }
+                p += 500;
             }
-            break;
+            else
+            {
+                p += 30;
+            }
+        }
+        break;
 
-            case 96+15:    /* RF6_XXX6X6 */
-            break;
+        case 96+15:    /* RF6_XXX6X6 */
+        break;
 
-            /* Summoning is only as dangerous as the monster that is
-             * actually summoned but the monsters that summon are a priority
-             * to kill.  PFE reduces danger from some evil summoned monsters
-             * One Problem with GOI and Create Door is that the GOI reduces
-             * the fear so much that the borg won't cast the Create Door,
-             * eventhough it would be a good idea.
-             */
+        /* Summoning is only as dangerous as the monster that is
+         * actually summoned but the monsters that summon are a priority
+         * to kill.  PFE reduces danger from some evil summoned monsters
+         * One Problem with GOI and Create Door is that the GOI reduces
+         * the fear so much that the borg won't cast the Create Door,
+         * eventhough it would be a good idea.
+         */
 
-            case 96+16:    /* S_KIN */
+        case 96+16:    /* S_KIN */
 			/* This is used to calculate the free squares next to us.
 			 * This is important when dealing with summoners.
 			 */
@@ -7479,24 +7430,24 @@ static int borg_danger_aux2(int i, int y, int x, bool average, bool full_damage)
 
 				}
 			}
-            if (pfe )
-            {    p +=(lev);
-                p = p / spot_safe;
-            }
-            else if (glyph || borg_create_door || borg_fighting_unique)
-            {    p +=(lev) * 3;
-                p = p / spot_safe;
-            }
-            else
-            {    p += (lev) * 7;
-                p = p / spot_safe;
-            }
-            /* reduce the fear if it is a unique */
-            if (rf_has(r_info->flags, RF_UNIQUE)) p = p * 75/100;
+        if (pfe )
+        {    p +=(lev);
+            p = p / spot_safe;
+        }
+        else if (glyph || borg_create_door || borg_fighting_unique)
+        {    p +=(lev) * 3;
+            p = p / spot_safe;
+        }
+        else
+        {    p += (lev) * 7;
+            p = p / spot_safe;
+        }
+        /* reduce the fear if it is a unique */
+        if (rf_has(r_info->flags, RF_UNIQUE)) p = p * 75/100;
 
-            break;
+        break;
 
-            case 96+17:    /* S_HI_DEMON */
+        case 96+17:    /* S_HI_DEMON */
 			/* This is used to calculate the free squares next to us.
 			 * This is important when dealing with summoners.
 			 */
@@ -7527,24 +7478,24 @@ static int borg_danger_aux2(int i, int y, int x, bool average, bool full_damage)
 
 				}
 			}
-            if (pfe )
-            {    p +=(lev);
-                p = p / spot_safe;
-            }
-            else if (glyph || borg_create_door || borg_fighting_unique)
-            {    p +=(lev) * 6;
-                p = p / spot_safe;
-            }
-            else
-            {    p += (lev) * 12;
-                p = p / spot_safe;
-            }
-            /* reduce the fear if it is a unique */
-            if (rf_has(r_info->flags, RF_UNIQUE)) p = p * 75/100;
-            break;
+        if (pfe )
+        {    p +=(lev);
+            p = p / spot_safe;
+        }
+        else if (glyph || borg_create_door || borg_fighting_unique)
+        {    p +=(lev) * 6;
+            p = p / spot_safe;
+        }
+        else
+        {    p += (lev) * 12;
+            p = p / spot_safe;
+        }
+        /* reduce the fear if it is a unique */
+        if (rf_has(r_info->flags, RF_UNIQUE)) p = p * 75/100;
+        break;
 
 
-            case 96+18:    /* RF6_S_MONSTER */
+        case 96+18:    /* RF6_S_MONSTER */
 			/* This is used to calculate the free squares next to us.
 			 * This is important when dealing with summoners.
 			 */
@@ -7575,15 +7526,15 @@ static int borg_danger_aux2(int i, int y, int x, bool average, bool full_damage)
 
 				}
 			}
-            if (pfe || glyph || borg_create_door || borg_fighting_unique)
-                p +=0;
-            else
-            {    p += (lev) * 5;
-                p = p / spot_safe;
-            }
-            break;
+        if (pfe || glyph || borg_create_door || borg_fighting_unique)
+            p +=0;
+        else
+        {    p += (lev) * 5;
+            p = p / spot_safe;
+        }
+        break;
 
-            case 96+19:    /* RF6_S_MONSTERS */
+        case 96+19:    /* RF6_S_MONSTERS */
 			/* This is used to calculate the free squares next to us.
 			 * This is important when dealing with summoners.
 			 */
@@ -7614,17 +7565,17 @@ static int borg_danger_aux2(int i, int y, int x, bool average, bool full_damage)
 
 				}
 			}
-            if (pfe || glyph || borg_create_door || borg_fighting_unique)
-                p +=0;
-            else
-            {    p += (lev) * 7;
-                 p = p / spot_safe;
-            }
-            /* reduce the fear if it is a unique */
-            if (rf_has(r_info->flags, RF_UNIQUE)) p = p * 75/100;
-            break;
+        if (pfe || glyph || borg_create_door || borg_fighting_unique)
+            p +=0;
+        else
+        {    p += (lev) * 7;
+             p = p / spot_safe;
+        }
+        /* reduce the fear if it is a unique */
+        if (rf_has(r_info->flags, RF_UNIQUE)) p = p * 75/100;
+        break;
 
-            case 96+20:   /* RF6_S_ANIMAL */
+        case 96+20:   /* RF6_S_ANIMAL */
 			/* This is used to calculate the free squares next to us.
 			 * This is important when dealing with summoners.
 			 */
@@ -7655,17 +7606,17 @@ static int borg_danger_aux2(int i, int y, int x, bool average, bool full_damage)
 
 				}
 			}
-            if (pfe || glyph || borg_create_door || borg_fighting_unique)
-                p +=0;
-            else
-            {   p += (lev) * 5;
-                p = p / spot_safe;
-            }
-            /* reduce the fear if it is a unique */
-            if (rf_has(r_info->flags, RF_UNIQUE)) p = p * 75/100;
-            break;
+        if (pfe || glyph || borg_create_door || borg_fighting_unique)
+            p +=0;
+        else
+        {   p += (lev) * 5;
+            p = p / spot_safe;
+        }
+        /* reduce the fear if it is a unique */
+        if (rf_has(r_info->flags, RF_UNIQUE)) p = p * 75/100;
+        break;
 
-            case 96+21:    /* RF6_S_SPIDER */
+        case 96+21:    /* RF6_S_SPIDER */
 			/* This is used to calculate the free squares next to us.
 			 * This is important when dealing with summoners.
 			 */
@@ -7696,17 +7647,17 @@ static int borg_danger_aux2(int i, int y, int x, bool average, bool full_damage)
 
 				}
 			}
-            if (pfe || glyph || borg_create_door || borg_fighting_unique)
-                p +=0;
-            else
-            {   p += (lev) * 5;
-                p = p / spot_safe;
-            }
-            /* reduce the fear if it is a unique */
-            if (rf_has(r_info->flags, RF_UNIQUE)) p = p * 75/100;
-            break;
+        if (pfe || glyph || borg_create_door || borg_fighting_unique)
+            p +=0;
+        else
+        {   p += (lev) * 5;
+            p = p / spot_safe;
+        }
+        /* reduce the fear if it is a unique */
+        if (rf_has(r_info->flags, RF_UNIQUE)) p = p * 75/100;
+        break;
 
-            case 96+22:    /* RF6_S_HOUND */
+        case 96+22:    /* RF6_S_HOUND */
 			/* This is used to calculate the free squares next to us.
 			 * This is important when dealing with summoners.
 			 */
@@ -7737,17 +7688,17 @@ static int borg_danger_aux2(int i, int y, int x, bool average, bool full_damage)
 
 				}
 			}
-            if (pfe || glyph || borg_create_door || borg_fighting_unique)
-                p +=0;
-            else
-            {    p += (lev) * 5;
-                p = p / spot_safe;
-            }
-            /* reduce the fear if it is a unique */
-            if (rf_has(r_info->flags, RF_UNIQUE)) p = p * 75/100;
-            break;
+        if (pfe || glyph || borg_create_door || borg_fighting_unique)
+            p +=0;
+        else
+        {    p += (lev) * 5;
+            p = p / spot_safe;
+        }
+        /* reduce the fear if it is a unique */
+        if (rf_has(r_info->flags, RF_UNIQUE)) p = p * 75/100;
+        break;
 
-            case 96+23:    /* RF6_S_HYDRA */
+        case 96+23:    /* RF6_S_HYDRA */
 			/* This is used to calculate the free squares next to us.
 			 * This is important when dealing with summoners.
 			 */
@@ -7778,23 +7729,23 @@ static int borg_danger_aux2(int i, int y, int x, bool average, bool full_damage)
 
 				}
 			}
-            if (pfe )
-            {    p +=(lev);
-                p = p / spot_safe;
-            }
-            else if (glyph || borg_create_door || borg_fighting_unique)
-            {   p +=(lev) * 2;
-                p = p / spot_safe;
-            }
-            else
-            {   p += (lev) * 5;
-                p = p / spot_safe;
-            }
-            /* reduce the fear if it is a unique */
-            if (rf_has(r_info->flags, RF_UNIQUE)) p = p * 75/100;
-            break;
+        if (pfe )
+        {    p +=(lev);
+            p = p / spot_safe;
+        }
+        else if (glyph || borg_create_door || borg_fighting_unique)
+        {   p +=(lev) * 2;
+            p = p / spot_safe;
+        }
+        else
+        {   p += (lev) * 5;
+            p = p / spot_safe;
+        }
+        /* reduce the fear if it is a unique */
+        if (rf_has(r_info->flags, RF_UNIQUE)) p = p * 75/100;
+        break;
 
-            case 96+24:    /* RF6_S_ANGEL */
+        case 96+24:    /* RF6_S_ANGEL */
 			/* This is used to calculate the free squares next to us.
 			 * This is important when dealing with summoners.
 			 */
@@ -7825,23 +7776,23 @@ static int borg_danger_aux2(int i, int y, int x, bool average, bool full_damage)
 
 				}
 			}
-            if (pfe  || borg_fighting_unique)
-            {    p +=(lev);
-                p = p / spot_safe;
-            }
-            else if (glyph || borg_create_door || borg_fighting_unique)
-            {    p +=(lev)* 3;
-                p = p / spot_safe;
-            }
-            else
-            {    p += (lev) * 7;
-                p = p / spot_safe;
-            }
-            /* reduce the fear if it is a unique */
-            if (rf_has(r_info->flags, RF_UNIQUE)) p = p * 75/100;
-            break;
+        if (pfe  || borg_fighting_unique)
+        {    p +=(lev);
+            p = p / spot_safe;
+        }
+        else if (glyph || borg_create_door || borg_fighting_unique)
+        {    p +=(lev)* 3;
+            p = p / spot_safe;
+        }
+        else
+        {    p += (lev) * 7;
+            p = p / spot_safe;
+        }
+        /* reduce the fear if it is a unique */
+        if (rf_has(r_info->flags, RF_UNIQUE)) p = p * 75/100;
+        break;
 
-            case 96+25:    /* RF6_S_DEMON */
+        case 96+25:    /* RF6_S_DEMON */
 			/* This is used to calculate the free squares next to us.
 			 * This is important when dealing with summoners.
 			 */
@@ -7872,23 +7823,23 @@ static int borg_danger_aux2(int i, int y, int x, bool average, bool full_damage)
 
 				}
 			}
-            if (pfe )
-            {    p +=(lev);
-                p = p / spot_safe;
-            }
-            else if (glyph || borg_create_door || borg_fighting_unique)
-            {    p +=(lev) * 3;
-                p = p / spot_safe;
-            }
-            else
-            {    p += (lev) * 7;
-                p = p / spot_safe;
-            }
-            /* reduce the fear if it is a unique */
-            if (rf_has(r_info->flags, RF_UNIQUE)) p = p * 75/100;
-            break;
+        if (pfe )
+        {    p +=(lev);
+            p = p / spot_safe;
+        }
+        else if (glyph || borg_create_door || borg_fighting_unique)
+        {    p +=(lev) * 3;
+            p = p / spot_safe;
+        }
+        else
+        {    p += (lev) * 7;
+            p = p / spot_safe;
+        }
+        /* reduce the fear if it is a unique */
+        if (rf_has(r_info->flags, RF_UNIQUE)) p = p * 75/100;
+        break;
 
-            case 96+26:    /* RF6_S_UNDEAD */
+        case 96+26:    /* RF6_S_UNDEAD */
 			/* This is used to calculate the free squares next to us.
 			 * This is important when dealing with summoners.
 			 */
@@ -7919,23 +7870,23 @@ static int borg_danger_aux2(int i, int y, int x, bool average, bool full_damage)
 
 				}
 			}
-            if (pfe )
-            {    p +=(lev);
-                p = p / spot_safe;
-            }
-            else if (glyph || borg_create_door || borg_fighting_unique)
-            {    p +=(lev) * 3;
-                p = p / spot_safe;
-            }
-            else
-            {    p += (lev) * 7;
-                p = p / spot_safe;
-            }
-            /* reduce the fear if it is a unique */
-            if (rf_has(r_info->flags, RF_UNIQUE)) p = p * 75/100;
-            break;
+        if (pfe )
+        {    p +=(lev);
+            p = p / spot_safe;
+        }
+        else if (glyph || borg_create_door || borg_fighting_unique)
+        {    p +=(lev) * 3;
+            p = p / spot_safe;
+        }
+        else
+        {    p += (lev) * 7;
+            p = p / spot_safe;
+        }
+        /* reduce the fear if it is a unique */
+        if (rf_has(r_info->flags, RF_UNIQUE)) p = p * 75/100;
+        break;
 
-            case 96+27:    /* RF6_S_DRAGON */
+        case 96+27:    /* RF6_S_DRAGON */
 			/* This is used to calculate the free squares next to us.
 			 * This is important when dealing with summoners.
 			 */
@@ -7966,23 +7917,23 @@ static int borg_danger_aux2(int i, int y, int x, bool average, bool full_damage)
 
 				}
 			}
-            if (pfe )
-            {    p +=(lev);
-                p = p / spot_safe;
-            }
-            else if (glyph || borg_create_door || borg_fighting_unique)
-            {    p +=(lev) * 3;
-                p = p / spot_safe;
-            }
-            else
-            {    p += (lev) * 7;
-                p = p / spot_safe;
-            }
-            /* reduce the fear if it is a unique */
-            if (rf_has(r_info->flags, RF_UNIQUE)) p = p * 75/100;
-            break;
+        if (pfe )
+        {    p +=(lev);
+            p = p / spot_safe;
+        }
+        else if (glyph || borg_create_door || borg_fighting_unique)
+        {    p +=(lev) * 3;
+            p = p / spot_safe;
+        }
+        else
+        {    p += (lev) * 7;
+            p = p / spot_safe;
+        }
+        /* reduce the fear if it is a unique */
+        if (rf_has(r_info->flags, RF_UNIQUE)) p = p * 75/100;
+        break;
 
-            case 96+28:    /* RF6_S_HI_UNDEAD */
+        case 96+28:    /* RF6_S_HI_UNDEAD */
 			/* This is used to calculate the free squares next to us.
 			 * This is important when dealing with summoners.
 			 */
@@ -8013,23 +7964,23 @@ static int borg_danger_aux2(int i, int y, int x, bool average, bool full_damage)
 
 				}
 			}
-            if (pfe )
-            {    p +=(lev);
-                p = p / spot_safe;
-            }
-            else if (glyph || borg_create_door || borg_fighting_unique)
-            {    p +=(lev) * 6;
-                p = p / spot_safe;
-            }
-            else
-            {    p += (lev) * 12;
-                p = p / spot_safe;
-            }
-            /* reduce the fear if it is a unique */
-            if (rf_has(r_info->flags, RF_UNIQUE)) p = p * 75/100;
-            break;
+        if (pfe )
+        {    p +=(lev);
+            p = p / spot_safe;
+        }
+        else if (glyph || borg_create_door || borg_fighting_unique)
+        {    p +=(lev) * 6;
+            p = p / spot_safe;
+        }
+        else
+        {    p += (lev) * 12;
+            p = p / spot_safe;
+        }
+        /* reduce the fear if it is a unique */
+        if (rf_has(r_info->flags, RF_UNIQUE)) p = p * 75/100;
+        break;
 
-            case 96+29:    /* RF6_S_HI_DRAGON */
+        case 96+29:    /* RF6_S_HI_DRAGON */
 			/* This is used to calculate the free squares next to us.
 			 * This is important when dealing with summoners.
 			 */
@@ -8060,23 +8011,23 @@ static int borg_danger_aux2(int i, int y, int x, bool average, bool full_damage)
 
 				}
 			}
-            if (pfe )
-            {
-                p = p / spot_safe;
-            }
-            else if (glyph || borg_create_door || borg_fighting_unique)
-            {    p +=(lev) * 6;
-                p = p / spot_safe;
-            }
-            else
-            {    p += (lev) * 12;
-                p = p / spot_safe;
-            }
-            /* reduce the fear if it is a unique */
-            if (rf_has(r_info->flags, RF_UNIQUE)) p = p * 75/100;
-            break;
+        if (pfe )
+        {
+            p = p / spot_safe;
+        }
+        else if (glyph || borg_create_door || borg_fighting_unique)
+        {    p +=(lev) * 6;
+            p = p / spot_safe;
+        }
+        else
+        {    p += (lev) * 12;
+            p = p / spot_safe;
+        }
+        /* reduce the fear if it is a unique */
+        if (rf_has(r_info->flags, RF_UNIQUE)) p = p * 75/100;
+        break;
 
-            case 96+30:    /* RF6_S_WRAITH */
+        case 96+30:    /* RF6_S_WRAITH */
 			/* This is used to calculate the free squares next to us.
 			 * This is important when dealing with summoners.
 			 */
@@ -8107,72 +8058,353 @@ static int borg_danger_aux2(int i, int y, int x, bool average, bool full_damage)
 
 				}
 			}
-            if (pfe )
-            {    p +=(lev);
-                p = p / spot_safe;
-            }
-            else if (glyph || borg_create_door || borg_fighting_unique)
-            {    p +=(lev) * 6;
-                p = p / spot_safe;
-            }
-            else
-            {    p += (lev) * 12;
-                p = p / spot_safe;
-            }
-            /* reduce the fear if it is a unique */
-            if (rf_has(r_info->flags, RF_UNIQUE)) p = p * 75/100;
-            break;
+        if (pfe )
+        {    p +=(lev);
+            p = p / spot_safe;
+        }
+        else if (glyph || borg_create_door || borg_fighting_unique)
+        {    p +=(lev) * 6;
+            p = p / spot_safe;
+        }
+        else
+        {    p += (lev) * 12;
+            p = p / spot_safe;
+        }
+        /* reduce the fear if it is a unique */
+        if (rf_has(r_info->flags, RF_UNIQUE)) p = p * 75/100;
+        break;
+
+        case 96+31:    /* RF6_S_UNIQUE */
+			/* This is used to calculate the free squares next to us.
+			 * This is important when dealing with summoners.
+			 */
+			for (spot_x = -1; spot_x <= 1; spot_x++)
+			{
+				for (spot_y = -1; spot_y <= 1; spot_y++)
+				{
+					/* Acquire location */
+					x = spot_x + c_x;
+					y = spot_y + c_y;
+
+					ag = &borg_grids[y][x];
+
+					/* skip our own spot */
+					if (x == c_x && y == c_y) continue;
+
+					/* track spaces already protected */
+					if ( ag->feat == FEAT_GLYPH || ag->kill ||
+					   ((ag->feat >= FEAT_DOOR_HEAD) && (ag->feat <= FEAT_PERM_SOLID)))
+					{   /* track the safe areas for calculating danger */
+						spot_safe ++;
+
+						/* Just in case */
+						if (spot_safe == 0) spot_safe = 1;
+						if (spot_safe == 8) spot_safe = 100;
+						if (borg_morgoth_position) spot_safe = 1000;
+					}
+
+				}
+			}
+        if (pfe )
+        {    p +=(lev);
+            p = p / spot_safe;
+        }
+        else if (glyph || borg_create_door)
+        {    p +=(lev) * 3;    /* slightly reduced danger for unique */
+            p = p / spot_safe;
+        }
+        else
+        {    p += (lev) * 6;
+            p = p / spot_safe;
+        }
+        /* reduce the fear if it is a unique */
+        if (rf_has(r_info->flags, RF_UNIQUE)) p = p * 75/100;
+        break;
+    }
+
+
+
+    /* Keep the count of guarded grids */
+    *safe = spot_safe;
+
+    /* Notice damage */
+    return (p + z);
+}
+
+
+/*
+ * Threat profiles.
+ *
+ * What a race's blows and spells do to the borg depends on the race and
+ * on the borg's defences, not on where the monster stands.  Each race
+ * keeps its melee danger, and the worst and total danger of its fixed
+ * spells (see above).  A profile is good while the defences it was
+ * worked out against (see "borg_threat_ctx") and the short-lived flags
+ * (see "borg_threat_flags()") are unchanged.  Distance, speed and line
+ * of sight are still applied for each grid by "borg_danger_aux()".
+ *
+ * Define BORG_DANGER_CHECK to check each profile against the full
+ * calculation.
+ */
+static const s16b borg_threat_skills[] =
+{
+    BI_ARMOR, BI_CLEVEL, BI_MAXSP, BI_SAV,
+    BI_FOOD, BI_CURLITE, BI_AFUEL, BI_ISSTUN, BI_ISHEAVYSTUN,
+    BI_IACID, BI_IELEC, BI_IFIRE, BI_ICOLD,
+    BI_RACID, BI_RELEC, BI_RFIRE, BI_RCOLD, BI_RPOIS,
+    BI_RBLIND, BI_RCONF, BI_RFEAR, BI_RDARK, BI_RNTHR, BI_RSND, BI_RDIS,
+    BI_FRACT, BI_HLIFE,
+    BI_SSTR, BI_SINT, BI_SWIS, BI_SDEX, BI_SCON, BI_SCHR
+};
+
+#define BORG_THREAT_SKILLS \
+    ((int)(sizeof(borg_threat_skills) / sizeof(borg_threat_skills[0])))
+
+typedef struct borg_threat_ctx borg_threat_ctx;
+
+struct borg_threat_ctx
+{
+    s32b skill[BORG_THREAT_SKILLS];
+    s32b stat[6];
+    s32b dex_ind;
+    s32b class_idx;
+    s32b prayers;       /* Restore stats, restore life levels */
+};
+
+typedef struct borg_threat borg_threat;
+
+struct borg_threat
+{
+    u32b epoch;         /* "borg_threat_epoch" when worked out */
+    u32b flags;         /* "borg_threat_flags()" when worked out */
+
+    s32b melee[2];      /* Blows, partial and full damage */
+
+    byte num_spells;    /* Spells of the monster it was worked out for */
+    s32b spell_max;     /* Worst fixed spell */
+    s32b spell_sum;     /* All the fixed spells */
+
+    byte num_other;     /* Other spells, worked out each time */
+    byte other[96];     /* Their places in the spell list */
+};
+
+static borg_threat_ctx threat_ctx;
+static u32b borg_threat_epoch = 1;
+static borg_threat *borg_threats;
+
+
+/*
+ * The short-lived state that the profiles read
+ */
+static u32b borg_threat_flags(void)
+{
+    return ((borg_attacking ? 0x0001 : 0) |
+            (borg_shield ? 0x0002 : 0) |
+            (borg_prot_from_evil ? 0x0004 : 0) |
+            (borg_fighting_unique ? 0x0008 : 0) |
+            (my_oppose_fire ? 0x0010 : 0) |
+            (my_oppose_cold ? 0x0020 : 0) |
+            (my_oppose_acid ? 0x0040 : 0) |
+            (my_oppose_elec ? 0x0080 : 0) |
+            (my_oppose_pois ? 0x0100 : 0) |
+            ((borg_gold < 100) ? 0x0200 : 0) |
+            ((borg_gold > 100000) ? 0x0400 : 0));
+}
+
+
+/*
+ * Drop the threat profiles if the borg's defences changed
+ */
+void borg_threat_sync(void)
+{
+    borg_threat_ctx ctx;
+
+    int k;
+
+    WIPE(&ctx, borg_threat_ctx);
+
+    for (k = 0; k < BORG_THREAT_SKILLS; k++)
+    {
+        ctx.skill[k] = borg_skill[borg_threat_skills[k]];
+    }
+    for (k = 0; k < 6; k++)
+    {
+        ctx.stat[k] = borg_stat[k];
+    }
+    ctx.dex_ind = my_stat_ind[A_DEX];
+    ctx.class_idx = borg_class;
+    ctx.prayers = (borg_prayer_legal(6, 3) ? 0x01 : 0) |
+                  (borg_prayer_legal(6, 4) ? 0x02 : 0);
+
+    if (memcmp(&ctx, &threat_ctx, sizeof(ctx)))
+    {
+        threat_ctx = ctx;
+        borg_threat_epoch++;
+    }
+}
+
+
+/*
+ * Find (or work out) the threat profile of a monster's race
+ */
+static borg_threat *borg_threat_get(int i)
+{
+    borg_kill *kill = &borg_kills[i];
+
+    monster_race *r_ptr = &r_info[kill->r_idx];
+
+    borg_threat *t = &borg_threats[kill->r_idx];
+
+    byte *spell = borg_kill_spells[i].spell;
+
+    u32b flags = borg_threat_flags();
+
+    int q, p, spot_safe = 1;
+
+    /* Still good */
+    if (t->epoch == borg_threat_epoch && t->flags == flags &&
+        t->num_spells == kill->ranged_attack) return (t);
+
+    /* Blows */
+    t->melee[0] = borg_danger_melee(r_ptr, FALSE);
+    t->melee[1] = borg_danger_melee(r_ptr, TRUE);
+
+    /* Spells */
+    t->num_spells = kill->ranged_attack;
+    t->spell_max = 0;
+    t->spell_sum = 0;
+    t->num_other = 0;
+    for (q = 0; q < kill->ranged_attack; q++)
+    {
+        /* Not fixed */
+        if (!borg_danger_spell_fixed(spell[q]))
+        {
+            t->other[t->num_other++] = q;
+            continue;
+        }
+
+        p = borg_danger_spell(spell[q], r_ptr->level, 0, 0, 0, &spot_safe);
+
+        if (p > t->spell_max) t->spell_max = p;
+        t->spell_sum += p;
+    }
+
+    t->epoch = borg_threat_epoch;
+    t->flags = flags;
+
+    return (t);
+}
+
+
+/*
+ * Calculate base danger from a monster's physical attacks
+ */
+static int borg_danger_aux1(int i, bool full_damage)
+{
+    borg_kill *kill = &borg_kills[i];
+
+    borg_threat *t;
+
+    /* Mega-Hack -- unknown monsters */
+    if (kill->r_idx >= z_info->r_max) return (1000);
+
+    /* The race's profile */
+    t = borg_threat_get(i);
+
+#ifdef BORG_DANGER_CHECK
+    if (t->melee[full_damage ? 1 : 0] !=
+        borg_danger_melee(&r_info[kill->r_idx], full_damage))
+    {
+        borg_note(format("# Threat profile mismatch (melee) for %s",
+                         r_info[kill->r_idx].name));
+    }
+#endif
+
+    return (t->melee[full_damage ? 1 : 0]);
+}
+
+
+/*
+ * Calculate base danger from a monster's spell attacks
+ *
+ * We attempt to take account of various resistances, both in
+ * terms of actual damage, and special effects, as appropriate.
+ *
+ * We reduce the danger from distant "sleeping" monsters.
+ *
+ * We reduce the danger if the monster is immobile or not LOS
+ */
+static int borg_danger_aux2(int i, int y, int x, bool average, bool full_damage)
+{
+    int q, n= 0, pfe =0, glyph= 0, glyph_check =0;
+
+    int spot_safe=1;
+
+    int lev, hp, total_dam = 0, av;
 
-            case 96+31:    /* RF6_S_UNIQUE */
-			/* This is used to calculate the free squares next to us.
-			 * This is important when dealing with summoners.
-			 */
-			for (spot_x = -1; spot_x <= 1; spot_x++)
-			{
-				for (spot_y = -1; spot_y <= 1; spot_y++)
-				{
-					/* Acquire location */
-					x = spot_x + c_x;
-					y = spot_y + c_y;
+    borg_kill *kill = &borg_kills[i];
 
-					ag = &borg_grids[y][x];
+    byte *spell = borg_kill_spells[i].spell;
 
-					/* skip our own spot */
-					if (x == c_x && y == c_y) continue;
+    borg_threat *t;
 
-					/* track spaces already protected */
-					if ( ag->feat == FEAT_GLYPH || ag->kill ||
-					   ((ag->feat >= FEAT_DOOR_HEAD) && (ag->feat <= FEAT_PERM_SOLID)))
-					{   /* track the safe areas for calculating danger */
-						spot_safe ++;
+    monster_race *r_ptr = &r_info[kill->r_idx];
 
-						/* Just in case */
-						if (spot_safe == 0) spot_safe = 1;
-						if (spot_safe == 8) spot_safe = 100;
-						if (borg_morgoth_position) spot_safe = 1000;
-					}
+    /*  PFE gives a protection.  */
+        /* Hack -- Apply "protection from evil" */
+        if ( (borg_prot_from_evil) &&
+            (rf_has(r_ptr->flags, RF_EVIL)) &&
+            ((borg_skill[BI_CLEVEL] ) >= r_ptr->level) )
+        {
+            pfe = 1;
+        }
 
-				}
-			}
-            if (pfe )
-            {    p +=(lev);
-                p = p / spot_safe;
-            }
-            else if (glyph || borg_create_door)
-            {    p +=(lev) * 3;    /* slightly reduced danger for unique */
-                p = p / spot_safe;
-            }
-            else
-            {    p += (lev) * 6;
-                p = p / spot_safe;
+    /* glyph of warding rune of protection provides some small
+     * protection with some ranged atacks; mainly summon attacks.
+     * We should reduce the danger commensurate to the probability of the
+     * monster breaking the glyph as defined by melee2.c
+     */
+    if (borg_on_glyph)
+    {
+        glyph = 1;
+    }
+    else if (track_glyph_num)
+    {
+        /* Check all existing glyphs */
+        for (glyph_check = 0; glyph_check < track_glyph_num; glyph_check++)
+        {
+            if ((track_glyph_y[glyph_check] == y) && (track_glyph_x[glyph_check] == x))
+            {
+                /* Reduce the danger */
+                glyph = 1;
             }
-            /* reduce the fear if it is a unique */
-            if (rf_has(r_info->flags, RF_UNIQUE)) p = p * 75/100;
-            break;
         }
+    }
+
+    /* Mega-Hack -- unknown monsters */
+    if (kill->r_idx >= z_info->r_max) return (1000);
+
+
+    /* Paranoia -- Nothing to cast */
+	if (!kill->ranged_attack) return (0);
+
+
+    /* Extract the level */
+    lev = r_ptr->level;
+
+    /* Extract hit-points */
+    hp = kill->power;
 
-        /* Notice damage */
-        p += z;
+
+    /* The race's fixed spells */
+    t = borg_threat_get(i);
+    n = t->spell_max;
+    total_dam = t->spell_sum;
+
+    /* Analyze the other spells */
+	for (q = 0; q < t->num_other; q++)
+    {
+        int p = borg_danger_spell(spell[t->other[q]], lev, hp, pfe, glyph, &spot_safe);
 
         /* Track the most dangerous spell */
         if (p > n) n = p;
@@ -8181,6 +8413,26 @@ static int borg_danger_aux2(int i, int y, int x, bool average, bool full_damage)
         total_dam +=p;
     }
 
+#ifdef BORG_DANGER_CHECK
+    {
+        int n2 = 0, total2 = 0, safe2 = 1;
+
+        for (q = 0; q < kill->ranged_attack; q++)
+        {
+            int p = borg_danger_spell(spell[q], lev, hp, pfe, glyph, &safe2);
+
+            if (p > n2) n2 = p;
+            total2 += p;
+        }
+
+        if (n != n2 || total_dam != total2)
+        {
+            borg_note(format("# Threat profile mismatch (spells) for %s",
+                             r_ptr->name));
+        }
+    }
+#endif
+
 	/* Slightly decrease the danger if the borg is sitting in
 	 * a sea of runes.
 	 */
@@ -8788,29 +9040,167 @@ int borg_danger_aux(int y, int x, int c, int i, bool average, bool full_damage)
 
 
 /*
- * Hack -- Calculate the "danger" of the given grid.
- *
- * Currently based on the physical power of nearby monsters, as well
- * as the spell power of monsters which can target the given grid.
- *
- * This function is extremely expensive, mostly due to the number of
- * times it is called, and also to the fact that it calls its helper
- * functions about thirty times each per call.
+ * Danger map -- the last "borg_danger()" result for each grid.
  *
- * We need to do more intelligent processing with the "c" parameter,
- * since currently the Borg does not realize that backing into a
- * hallway is a good idea, since as far as he can tell, many of
- * the nearby monsters can "squeeze" into a single grid.
+ * An entry is good while its stamp matches "borg_danger_epoch".  The
+ * whole map is dropped at the start of each "borg_update()", whenever
+ * "borg_notice()" or the monster fear changes, and whenever the state
+ * that the danger code reads (see "borg_danger_ctx") differs from the
+ * previous call.  A monster that moves, falls asleep or is forgotten
+ * only drops the grids it can reach (see "borg_danger_forget()").
  *
- * Note that we also take account of the danger of the "region" in
- * which the grid is located, which allows us to apply some "fear"
- * of invisible monsters and things of that nature.
+ * Each entry also remembers the "c" and "average" it was asked with,
+ * so the one-turn checks at the borg's own grid do not drop the map
+ * that a longer look at the landing grids is filling in.
  *
- * Generally bool Average is TRUE.
+ * Define BORG_DANGER_CHECK to recompute every cached answer and note
+ * any difference in the borg log.
  */
-int borg_danger(int y, int x, int c, bool average, bool full_damage)
+typedef struct borg_danger_ctx borg_danger_ctx;
+
+struct borg_danger_ctx
+{
+    s32b c_y;
+    s32b c_x;
+    s32b flags;
+    s32b fighting_unique;
+    s32b glyph_num;
+    s32b tp_other_n;
+    s32b tp_other_hash;
+    s32b gold;
+    s32b cursp;
+    s32b curhp;
+    s32b maxhp;
+};
+
+static borg_danger_ctx danger_ctx;
+static u32b borg_danger_epoch = 1;
+u32b borg_kill_epoch = 0;
+static u32b borg_danger_stamp[AUTO_MAX_Y][AUTO_MAX_X];
+static s16b borg_danger_map[AUTO_MAX_Y][AUTO_MAX_X];
+static s16b borg_danger_how[AUTO_MAX_Y][AUTO_MAX_X];
+
+
+/*
+ * Drop the whole danger map
+ */
+void borg_danger_wipe_map(void)
+{
+    borg_danger_epoch++;
+}
+
+
+/*
+ * Drop the grids that a monster can threaten, from where it is now
+ * and from where it was last seen.
+ */
+void borg_danger_forget(int i)
+{
+    borg_kill *kill = &borg_kills[i];
+
+    int y, x, n;
+    int yy[2], xx[2];
+
+    yy[0] = kill->y;
+    xx[0] = kill->x;
+    yy[1] = kill->oy;
+    xx[1] = kill->ox;
+
+    for (n = 0; n < 2; n++)
+    {
+        int y1 = MAX(yy[n] - 20, 0);
+        int y2 = MIN(yy[n] + 20, AUTO_MAX_Y - 1);
+        int x1 = MAX(xx[n] - 20, 0);
+        int x2 = MIN(xx[n] + 20, AUTO_MAX_X - 1);
+
+        for (y = y1; y <= y2; y++)
+        {
+            for (x = x1; x <= x2; x++)
+            {
+                borg_danger_stamp[y][x] = 0;
+            }
+        }
+    }
+
+    /* Landing tables may have skipped or counted it */
+    borg_kill_epoch++;
+}
+
+
+/*
+ * Gather the state that "borg_danger_aux()" reads, besides the map,
+ * the monster list and the "borg_notice()" results.
+ */
+static void borg_danger_ctx_make(borg_danger_ctx *ctx)
+{
+    int i;
+
+    ctx->c_y = c_y;
+    ctx->c_x = c_x;
+    ctx->flags = (borg_attacking ? 0x0001 : 0) |
+                 (borg_morgoth_position ? 0x0002 : 0) |
+                 (borg_create_door ? 0x0004 : 0) |
+                 (borg_prot_from_evil ? 0x0008 : 0) |
+                 (borg_speed ? 0x0010 : 0) |
+                 (borg_shield ? 0x0020 : 0) |
+                 (borg_on_glyph ? 0x0040 : 0) |
+                 (borg_sleep_spell ? 0x0080 : 0) |
+                 (borg_sleep_spell_ii ? 0x0100 : 0) |
+                 (borg_slow_spell ? 0x0200 : 0) |
+                 (borg_confuse_spell ? 0x0400 : 0) |
+                 (borg_fear_mon_spell ? 0x0800 : 0) |
+                 (my_oppose_fire ? 0x1000 : 0) |
+                 (my_oppose_cold ? 0x2000 : 0) |
+                 (my_oppose_acid ? 0x4000 : 0) |
+                 (my_oppose_elec ? 0x8000 : 0) |
+                 (my_oppose_pois ? 0x10000 : 0) |
+                 ((time_this_panel > 1200 || borg_t > 25000) ? 0x20000 : 0) |
+                 ((time_this_panel <= 200) ? 0x40000 : 0);
+    ctx->fighting_unique = borg_fighting_unique;
+    ctx->glyph_num = track_glyph_num;
+    ctx->tp_other_n = borg_tp_other_n;
+    ctx->tp_other_hash = 0;
+    for (i = 1; i <= borg_tp_other_n; i++)
+    {
+        ctx->tp_other_hash = ctx->tp_other_hash * 31 + borg_tp_other_index[i];
+    }
+    ctx->gold = borg_gold;
+    ctx->cursp = borg_skill[BI_CURSP];
+    ctx->curhp = borg_skill[BI_CURHP];
+    ctx->maxhp = borg_skill[BI_MAXHP];
+}
+
+
+/*
+ * Drop the danger map if the circumstances changed since the last call,
+ * and return the current epoch.  Callers that keep their own tables of
+ * "borg_danger()" results can use the epoch to tell when to rebuild.
+ */
+u32b borg_danger_sync(void)
+{
+    borg_danger_ctx ctx;
+
+    borg_danger_ctx_make(&ctx);
+    if (memcmp(&ctx, &danger_ctx, sizeof(ctx)))
+    {
+        danger_ctx = ctx;
+        borg_danger_wipe_map();
+    }
+
+    /* The threat profiles too */
+    borg_threat_sync();
+
+    return (borg_danger_epoch);
+}
+
+
+/*
+ * Calculate the danger of a grid the slow way
+ */
+static int borg_danger_full(int y, int x, int c, bool average)
 {
-    int i, p=0;
+    int i, n, p=0;
+    bool full_damage;
 
     /* Base danger (from regional fear) but not within a vault.  Cheating the floor grid */
 	if (!(cave_info[y][x] & (CAVE_ICKY)))
@@ -8831,13 +9221,10 @@ int borg_danger(int y, int x, int c, bool average, bool full_damage)
 
     full_damage = TRUE;
 
-    /* Examine all the monsters */
-    for (i = 1; i < borg_kills_nxt; i++)
+    /* Examine all the live monsters */
+    for (n = 0; n < borg_kills_live_n; n++)
     {
-        borg_kill *kill = &borg_kills[i];
-
-        /* Skip dead monsters */
-        if (!kill->r_idx) continue;
+        i = borg_kills_live[n];
 
         /* Collect danger from monster */
         p += borg_danger_aux(y, x, c, i, average, full_damage);
@@ -8848,6 +9235,72 @@ int borg_danger(int y, int x, int c, bool average, bool full_damage)
 }
 
 
+/*
+ * Hack -- Calculate the "danger" of the given grid.
+ *
+ * Currently based on the physical power of nearby monsters, as well
+ * as the spell power of monsters which can target the given grid.
+ *
+ * This function is extremely expensive, mostly due to the number of
+ * times it is called, and also to the fact that it calls its helper
+ * functions about thirty times each per call.
+ *
+ * We need to do more intelligent processing with the "c" parameter,
+ * since currently the Borg does not realize that backing into a
+ * hallway is a good idea, since as far as he can tell, many of
+ * the nearby monsters can "squeeze" into a single grid.
+ *
+ * Note that we also take account of the danger of the "region" in
+ * which the grid is located, which allows us to apply some "fear"
+ * of invisible monsters and things of that nature.
+ *
+ * Generally bool Average is TRUE.
+ *
+ * The answer is remembered in the danger map until something it
+ * depends on changes.  The "full_damage" flag is ignored, as it
+ * always has been.
+ */
+int borg_danger(int y, int x, int c, bool average, bool full_damage)
+{
+    int p;
+    int how = (c << 1) | (average ? 1 : 0);
+
+    BORG_PROF_ENTER(BORG_PROF_DANGER);
+
+    /* Different circumstances */
+    (void)borg_danger_sync();
+
+    /* Known */
+    if (borg_danger_stamp[y][x] == borg_danger_epoch &&
+        borg_danger_how[y][x] == how)
+    {
+        p = borg_danger_map[y][x];
+
+#ifdef BORG_DANGER_CHECK
+        if (p != borg_danger_full(y, x, c, average))
+        {
+            borg_note(format("# Danger map mismatch at (%d,%d): %d, not %d",
+                             y, x, p, borg_danger_full(y, x, c, average)));
+        }
+#endif
+
+        BORG_PROF_LEAVE(BORG_PROF_DANGER);
+        return (p);
+    }
+
+    /* Calculate and remember */
+    p = borg_danger_full(y, x, c, average);
+    borg_danger_map[y][x] = p;
+    borg_danger_how[y][x] = how;
+    borg_danger_stamp[y][x] = borg_danger_epoch;
+
+    BORG_PROF_LEAVE(BORG_PROF_DANGER);
+
+    /* Return the danger */
+    return (p);
+}
+
+
 
 
 /*
@@ -9414,6 +9867,11 @@ static char borg_prepared_buffer[MAX_REASON];
  * This now returns a string with the reason you are not prepared.
  *
  */
+/*
+ * Set when "borg_prepared()" recounts the *Heal* potions in the home
+ */
+static bool borg_prepared_noticed;
+
 cptr borg_prepared(int depth)
 {
     cptr reason;
@@ -9458,6 +9916,7 @@ cptr borg_prepared(int depth)
 	{
         /* Must know exact number of Potions  in home */
         borg_notice_home(NULL, FALSE);
+        borg_prepared_noticed = TRUE;
 
        	strnfmt(borg_prepared_buffer, MAX_REASON, "Scumming *Heal* potions (%d to go).", 10-num_ezheal);
        	return (borg_prepared_buffer);
@@ -9468,6 +9927,7 @@ cptr borg_prepared(int depth)
     {
         /* Must know exact number of Potions  in home */
         borg_notice_home(NULL, FALSE);
+        borg_prepared_noticed = TRUE;
 
         /* Scum for 30*/
         if (num_ezheal_true + borg_skill[BI_AEZHEAL] < 30)
@@ -9540,12 +10000,172 @@ cptr borg_prepared(int depth)
 
 }
 
+
+/*
+ * Prepared depth cache.  The item searches call "borg_power()" for
+ * every combination they try, and most combinations change nothing
+ * that "borg_prepared()" looks at, so the answer is remembered against
+ * a pair of hashes of everything it reads.
+ */
+#define BORG_PREP_CACHE_MAX 64
+
+typedef struct borg_prep_entry borg_prep_entry;
+
+struct borg_prep_entry
+{
+    u32b hash1;         /* FNV-1a of the inputs */
+    u32b hash2;         /* djb2 of the inputs */
+    int max;            /* Deepest level asked about */
+    int depth;          /* Deepest level prepared for */
+    int ready_morgoth;  /* Resulting "borg_ready_morgoth" */
+    bool noticed;       /* The scan recounted the home */
+    s16b ezheal;        /* Resulting "num_ezheal" */
+    s16b ezheal_true;   /* Resulting "num_ezheal_true" */
+};
+
+static borg_prep_entry borg_prep_cache[BORG_PREP_CACHE_MAX];
+
+s32b borg_prep_hits = 0;
+s32b borg_prep_misses = 0;
+
+
+/*
+ * The skills "borg_restock()" and "borg_prepared_aux()" read.  Hashing
+ * only these lets the item searches hit the cache for every combination
+ * that differs in things the ladder never looks at.
+ */
+static const s16b borg_prepared_skills[] =
+{
+    BI_CDEPTH, BI_MAXDEPTH, BI_CLEVEL, BI_MAXCLEVEL, BI_MAXHP, BI_MAXSP,
+    BI_SPEED, BI_CURLITE, BI_LIGHT, BI_AFUEL, BI_FOOD, BI_RECALL,
+    BI_ACLW, BI_ACSW, BI_ACCW, BI_AHEAL, BI_AEZHEAL, BI_ASPEED,
+    BI_AESCAPE, BI_APHASE, BI_ATELEPORT, BI_ATELEPORTLVL,
+    BI_FRACT, BI_HLIFE, BI_SINV, BI_DINV, BI_ESP, BI_KING,
+    BI_RACID, BI_RELEC, BI_RCOLD,
+    BI_SRACID, BI_SRELEC, BI_SRFIRE, BI_SRCOLD, BI_SRPOIS,
+    BI_SRBLIND, BI_SRCONF, BI_SRDIS, BI_SRKAOS
+};
+
+#define BORG_PREPARED_SKILLS \
+    ((int)(sizeof(borg_prepared_skills) / sizeof(borg_prepared_skills[0])))
+
+
+/*
+ * Add one value to both hashes
+ */
+static void borg_prepared_hash_aux(u32b *h1, u32b *h2, s32b v)
+{
+    *h1 = (*h1 ^ (u32b)v) * 16777619UL;
+    *h2 = (*h2 * 33) + (u32b)v;
+}
+
+
+/*
+ * Hash everything "borg_prepared()" (and "borg_restock()") reads
+ */
+static void borg_prepared_hash(u32b *h1, u32b *h2, int max)
+{
+    int i;
+
+    *h1 = 2166136261UL;
+    *h2 = 5381;
+
+    borg_prepared_hash_aux(h1, h2, max);
+
+    for (i = 0; i < BORG_PREPARED_SKILLS; i++)
+    {
+        borg_prepared_hash_aux(h1, h2, borg_skill[borg_prepared_skills[i]]);
+    }
+
+    borg_prepared_hash_aux(h1, h2, borg_stat[A_STR]);
+    borg_prepared_hash_aux(h1, h2, borg_stat[A_INT]);
+    borg_prepared_hash_aux(h1, h2, borg_stat[A_WIS]);
+    borg_prepared_hash_aux(h1, h2, borg_stat[A_DEX]);
+    borg_prepared_hash_aux(h1, h2, borg_stat[A_CON]);
+
+    borg_prepared_hash_aux(h1, h2, borg_has[POTION_RES_MANA]);
+    borg_prepared_hash_aux(h1, h2, borg_has[POTION_HEAL]);
+    borg_prepared_hash_aux(h1, h2, borg_has[ROD_HEAL]);
+    borg_prepared_hash_aux(h1, h2, borg_class);
+    borg_prepared_hash_aux(h1, h2, borg_plays_risky);
+    borg_prepared_hash_aux(h1, h2, borg_kills_uniques);
+    borg_prepared_hash_aux(h1, h2, borg_no_deeper);
+    borg_prepared_hash_aux(h1, h2, (borg_t - borg_began < 10));
+    borg_prepared_hash_aux(h1, h2, (borg_t - borg_began < 100));
+    borg_prepared_hash_aux(h1, h2, weapon_swap_hold_life);
+    borg_prepared_hash_aux(h1, h2, armour_swap_hold_life);
+    borg_prepared_hash_aux(h1, h2, num_ezheal);
+    borg_prepared_hash_aux(h1, h2, num_ezheal_true);
+    borg_prepared_hash_aux(h1, h2, borg_numb_live_unique);
+    borg_prepared_hash_aux(h1, h2, borg_living_unique_index);
+    borg_prepared_hash_aux(h1, h2, borg_unique_depth);
+
+    /* Teleport Level is only asked about from level 99 */
+    if (borg_skill[BI_MAXDEPTH] == 99)
+    {
+        borg_prepared_hash_aux(h1, h2, borg_prayer_okay_fail(4, 3, 20) ||
+                                       borg_spell_okay_fail(6, 2, 20));
+    }
+}
+
+
+/*
+ * Determine how deep the Borg is "prepared" to go, stopping at the
+ * first level (from the surface) he is not prepared for, and at "max".
+ */
+int borg_prepared_depth(int max)
+{
+    int i;
+    u32b h1, h2;
+    borg_prep_entry *entry;
+
+    /* Look it up */
+    borg_prepared_hash(&h1, &h2, max);
+    entry = &borg_prep_cache[h1 % BORG_PREP_CACHE_MAX];
+
+    if (entry->hash1 == h1 && entry->hash2 == h2 && entry->max == max)
+    {
+        /* The scan would have recounted the home */
+        if (entry->noticed) borg_notice_home(NULL, FALSE);
+
+        /* Only good if the home holds what it did */
+        if (!entry->noticed || (num_ezheal == entry->ezheal &&
+                                num_ezheal_true == entry->ezheal_true))
+        {
+            borg_ready_morgoth = entry->ready_morgoth;
+            borg_prep_hits++;
+            return (entry->depth);
+        }
+    }
+
+    /* Scan from surface to deep, stop when not prepared */
+    borg_prep_misses++;
+    borg_prepared_noticed = FALSE;
+    for (i = 1; i <= max; i++)
+    {
+        if ((cptr)NULL != borg_prepared(i)) break;
+    }
+
+    /* Remember */
+    entry->hash1 = h1;
+    entry->hash2 = h2;
+    entry->max = max;
+    entry->depth = i - 1;
+    entry->ready_morgoth = borg_ready_morgoth;
+    entry->noticed = borg_prepared_noticed;
+    entry->ezheal = num_ezheal;
+    entry->ezheal_true = num_ezheal_true;
+
+    return (i - 1);
+}
+
 /*
  * Initialize this file
  */
 void borg_init_4(void)
 {
-    /* Do nothing? */
+    /* Make the threat profiles */
+    C_MAKE(borg_threats, z_info->r_max, borg_threat);
 }
 
 
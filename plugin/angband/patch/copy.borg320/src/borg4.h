@@ -59,6 +59,19 @@ extern int borg_danger_aux(int y, int x, int c, int i, bool average, bool full_d
  */
 extern int borg_danger(int y, int x, int c, bool average, bool full_damage);
 
+/*
+ * Forget remembered danger (all of it, or near one monster)
+ */
+extern void borg_danger_wipe_map(void);
+extern void borg_danger_forget(int i);
+extern u32b borg_kill_epoch;        /* Bumped when a monster changes */
+extern u32b borg_danger_sync(void);
+
+/*
+ * Drop the per-race threat profiles if the defences changed
+ */
+extern void borg_threat_sync(void);
+
 
 /*
  * Determine if the Borg is out of "crucial" supplies.
@@ -70,6 +83,17 @@ extern cptr borg_restock(int depth);
  */
 extern cptr borg_prepared(int depth);
 
+/*
+ * Determine how deep the Borg is "prepared" to go (cached)
+ */
+extern int borg_prepared_depth(int max);
+
+/*
+ * Prepared depths answered from the cache, and worked out
+ */
+extern s32b borg_prep_hits;
+extern s32b borg_prep_misses;
+
 
 /*
  * Initialize this file
@@ -91,6 +91,19 @@ static int borg_normal_size;        /* Number of normals */
 static s16b *borg_normal_what;      /* Indexes of normals */
 static cptr *borg_normal_text;      /* Names of normals */
 
+/*
+ * Hack -- hash the monster names
+ *
+ * Each table maps a name to one plus its index in the sorted list (or
+ * zero for an empty slot), with linear probing.  The tables are kept
+ * at most a quarter full.  Normals that share a name only store the
+ * last one, and the others are found by walking back in the list.
+ */
+
+static int borg_name_hash_mask;     /* Size of the tables, less one */
+static s16b *borg_unique_hash;      /* Hash of unique names */
+static s16b *borg_normal_hash;      /* Hash of normal names */
+
 
 
 /*
@@ -122,6 +135,28 @@ static int borg_wank_num = 0;
 static borg_wank *borg_wanks;
 
 
+/*
+ * Hack -- what "borg_update_map()" saw and left at each grid
+ */
+
+#define BORG_MAP_INFO \
+    (BORG_MARK | BORG_GLOW | BORG_DARK | BORG_OKAY | BORG_LIGHT)
+
+static byte borg_map_a[AUTO_MAX_Y][AUTO_MAX_X];     /* Glyph attr */
+static byte borg_map_c[AUTO_MAX_Y][AUTO_MAX_X];     /* Glyph char */
+static byte borg_map_feat[AUTO_MAX_Y][AUTO_MAX_X];  /* Feature left */
+static byte borg_map_info[AUTO_MAX_Y][AUTO_MAX_X];  /* Flags left */
+static bool borg_map_wank[AUTO_MAX_Y][AUTO_MAX_X];  /* Monster/object */
+
+static bool borg_map_ready = FALSE;     /* Seen a panel yet */
+static bool borg_map_low;               /* Tracking doors */
+static s16b borg_map_less;              /* Tracking list sizes */
+static s16b borg_map_more;
+static s16b borg_map_glyph;
+static s16b borg_map_closed;
+static s16b borg_map_vein;
+
+
 
 
 /*
@@ -247,6 +282,7 @@ void borg_delete_take(int i)
 
     /* Forget it */
     ag->take = 0;
+    borg_cell_del(&borg_take_cells, i, take->y, take->x);
 
     /* Kill the object */
     WIPE(take, borg_take);
@@ -259,6 +295,24 @@ void borg_delete_take(int i)
 }
 
 
+/*
+ * Forget every "take" record
+ *
+ * Only the entries handed out since the last reset can be dirty, so
+ * only those are wiped (stale grid references may still read them).
+ */
+void borg_forget_takes(void)
+{
+    /* Forget old objects */
+    C_WIPE(borg_takes, borg_takes_nxt, borg_take);
+    borg_cell_wipe(&borg_take_cells);
+
+    /* No objects here */
+    borg_takes_cnt = 0;
+    borg_takes_nxt = 1;
+}
+
+
 /*
  * Determine if an object should be "viewable"
  */
@@ -348,6 +402,9 @@ static int borg_new_take(int k_idx, int y, int x)
     {
         /* Acquire the entry, advance */
         n = borg_takes_nxt++;
+
+        /* Start clean */
+        WIPE(&borg_takes[n], borg_take);
     }
 
     /* Hack -- steal an old object */
@@ -379,6 +436,7 @@ static int borg_new_take(int k_idx, int y, int x)
 
     /* Save the index */
     ag->take = n;
+    borg_cell_add(&borg_take_cells, n, y, x);
 
     /* Timestamp */
     take->when = borg_t;
@@ -409,7 +467,7 @@ static int borg_new_take(int k_idx, int y, int x)
     if (borg_skill[BI_CURLITE]) goal = 0;
 
 	/* Hack -- Force the object to sit on a floor grid */
-	ag->feat = FEAT_FLOOR;
+	borg_set_feat(ag, FEAT_FLOOR);
 
     /* Result */
     return (n);
@@ -457,17 +515,22 @@ static bool observe_take_diff(int y, int x, byte a, char c)
  */
 static bool observe_take_move(int y, int x, int d, byte a, char c)
 {
-    int i, z, ox, oy;
+    int i, k, n, z, ox, oy;
+
+    byte list[256];
 
     object_kind *k_ptr;
 
-    /* Scan the objects */
-    for (i = 1; i < borg_takes_nxt; i++)
+    /* Find the objects near the grid */
+    n = borg_cell_query(&borg_take_cells, y, x, d, list);
+
+    /* Scan them */
+    for (k = 0; k < n; k++)
     {
-        borg_take *take = &borg_takes[i];
+        borg_take *take;
 
-        /* Skip dead objects */
-        if (!take->k_idx) continue;
+        i = list[k];
+        take = &borg_takes[i];
 
         /* Skip assigned objects */
         if (take->seen) continue;
@@ -511,6 +574,7 @@ static bool observe_take_move(int y, int x, int d, byte a, char c)
 
             /* Update the grids */
             borg_grids[take->y][take->x].take = i;
+            borg_cell_move(&borg_take_cells, i, oy, ox, y, x);
 
             /* Note */
             borg_note(format("# Tracking an object '%s' at (%d,%d) from (%d,%d)",
@@ -528,7 +592,7 @@ static bool observe_take_move(int y, int x, int d, byte a, char c)
         take->seen = TRUE;
 
 		/* Mark floor underneath */
-		borg_grids[take->y][take->x].feat = FEAT_FLOOR;
+		borg_set_feat(&borg_grids[take->y][take->x], FEAT_FLOOR);
 
         /* Done */
         return (TRUE);
@@ -696,26 +760,77 @@ static int borg_guess_race(byte a, char c, bool multi, int y, int x)
 }
 
 
+/*
+ * Hash a monster name
+ */
+static int borg_name_hash(cptr str)
+{
+    u32b h = 2166136261UL;
+
+    while (*str)
+    {
+        h ^= (byte)*str++;
+        h *= 16777619UL;
+    }
+
+    return (int)(h & borg_name_hash_mask);
+}
+
+
+/*
+ * Find a name in a sorted list through its hash, or -1
+ */
+static int borg_name_find(s16b *table, cptr *text, cptr who)
+{
+    int h;
+
+    for (h = borg_name_hash(who); table[h]; h = (h + 1) & borg_name_hash_mask)
+    {
+        if (streq(text[table[h] - 1], who)) return (table[h] - 1);
+    }
+
+    return (-1);
+}
+
+
+/*
+ * Build the hash of a sorted list of names
+ */
+static void borg_name_hash_make(s16b **table, cptr *text, int size)
+{
+    int i, h;
+
+    C_MAKE(*table, borg_name_hash_mask + 1, s16b);
+
+    for (i = 0; i < size; i++)
+    {
+        /* Only the last of a run of equal names */
+        if ((i + 1 < size) && streq(text[i], text[i + 1])) continue;
+
+        /* Find an empty slot */
+        for (h = borg_name_hash(text[i]); (*table)[h];
+             h = (h + 1) & borg_name_hash_mask) /* loop */;
+
+        (*table)[h] = i + 1;
+    }
+}
+
+
 /*
  * Attempt to convert a monster name into a race index
  *
  * First we check for all possible "unique" monsters, including
  * ones we have killed, and even if the monster name is "prefixed"
  * (as in "The Tarrasque" and "The Lernean Hydra").  Since we use
- * a fast binary search, this is acceptable.
+ * a hash of the names, this is acceptable.
  *
  * Otherwise, if the monster is NOT named "The xxx", we assume it
  * must be a "player ghost" (which is impossible).
  *
- * Then, we do a binary search on all "normal" monster names, using
- * a search which is known to find the last matching entry, if one
- * exists, and otherwise to find an entry which would follow the
- * matching entry if there was one, unless the matching entry would
- * follow all the existing entries, in which case it will find the
- * final entry in the list.  Thus, we can search *backwards* from
- * the result of the search, and know that we will access all of
- * the matching entries, as long as we stop once we find an entry
- * which does not match, since this will catch all cases above.
+ * Then, we look up the "normal" monster names, which finds the
+ * last of the (sorted) entries with that name.  We search *backwards*
+ * from there, and stop once we find an entry which does not match,
+ * so we see all the races that share the name.
  *
  * Finally, we assume the monster must be a "player ghost" (which
  * as noted above is impossible), which is a hack, but may prevent
@@ -723,7 +838,7 @@ static int borg_guess_race(byte a, char c, bool multi, int y, int x)
  */
 static int borg_guess_race_name(cptr who)
 {
-    int k, m, n;
+    int k, m;
 
     int i, b_i = 0;
     int s, b_s = 0;
@@ -734,30 +849,11 @@ static int borg_guess_race_name(cptr who)
 
     int len = strlen(who);
 
-    /* Start the search */
-    m = 0; n = borg_unique_size;
+    /* Look for a unique */
+    m = borg_name_find(borg_unique_hash, borg_unique_text, who);
 
-    /* Binary search */
-    while (m < n - 1)
-    {
-        /* Pick a "middle" entry */
-        i = (m + n) / 2;
-
-        /* Search to the right (or here) */
-        if (strcmp(borg_unique_text[i], who) <= 0)
-        {
-            m = i;
-        }
-
-        /* Search to the left */
-        else
-        {
-            n = i;
-        }
-    }
-
-    /* Check for equality */
-    if (streq(who, borg_unique_text[m]))
+    /* Found it */
+    if (m >= 0)
     {
         /* Use this monster */
         return (borg_unique_what[m]);
@@ -790,27 +886,8 @@ static int borg_guess_race_name(cptr who)
     who += 4;
 
 
-    /* Start the search */
-    m = 0; n = borg_normal_size;
-
-    /* Binary search */
-    while (m < n - 1)
-    {
-        /* Pick a "middle" entry */
-        i = (m + n) / 2;
-
-        /* Search to the right (or here) */
-        if (strcmp(borg_normal_text[i], who) <= 0)
-        {
-            m = i;
-        }
-
-        /* Search to the left */
-        else
-        {
-            n = i;
-        }
-    }
+    /* Find the last normal with this name */
+    m = borg_name_find(borg_normal_hash, borg_normal_text, who);
 
     /* Scan possibilities */
     for (k = m; k >= 0; k--)
@@ -866,6 +943,9 @@ static void borg_fear_grid(cptr who, int y, int x, int k)  /* 8-8, this was uint
 {
 	int x1=0, y1=0;
 
+	/* Remembered danger included the old fear */
+	borg_danger_wipe_map();
+
 	/* Not in town */
 	if (borg_skill[BI_CDEPTH] == 0) return;
 
@@ -934,6 +1014,9 @@ static void borg_fear_regional(cptr who, int y, int x, int k, bool seen_guy) /*
 {
     int x0, y0, x1, x2, y1, y2;
 
+    /* Remembered danger included the old fear */
+    borg_danger_wipe_map();
+
 	/* Do not add fear in a vault -- Cheating the cave info */
   	if (cave_info[y][x] & CAVE_ICKY) return;
 
@@ -1057,27 +1140,27 @@ static void borg_update_kill_new(int i)
     else kill->stunned = TRUE;
 
 	/* Preload the spells from the race into this individual monster */
-	kill->spell_flags[0] = r_ptr->spell_flags[0];
-	kill->spell_flags[1] = r_ptr->spell_flags[1];
-	kill->spell_flags[2] = r_ptr->spell_flags[2];
+	borg_kill_spells[i].spell_flags[0] = r_ptr->spell_flags[0];
+	borg_kill_spells[i].spell_flags[1] = r_ptr->spell_flags[1];
+	borg_kill_spells[i].spell_flags[2] = r_ptr->spell_flags[2];
 
     /* Can it attack from a distance? */
     /* Extract the "inate" spells */
     for (k = 0; k < 32; k++)
     {
-        if (r_ptr->spell_flags[0] & (1L << k)) kill->spell[num++] = k + 32 ;
+        if (r_ptr->spell_flags[0] & (1L << k)) borg_kill_spells[i].spell[num++] = k + 32 ;
     }
 
     /* Extract the "normal" spells */
     for (k = 0; k < 32; k++)
     {
-        if (r_ptr->spell_flags[1] & (1L << k)) kill->spell[num++] = k + 32 * 2;
+        if (r_ptr->spell_flags[1] & (1L << k)) borg_kill_spells[i].spell[num++] = k + 32 * 2;
     }
 
     /* Extract the "bizarre" spells */
     for (k = 0; k < 32; k++)
     {
-        if (r_ptr->spell_flags[2] & (1L << k)) kill->spell[num++] = k + 32 * 3;
+        if (r_ptr->spell_flags[2] & (1L << k)) borg_kill_spells[i].spell[num++] = k + 32 * 3;
     }
 
 	/* Store the number of ranged attacks */
@@ -1102,7 +1185,7 @@ static void borg_update_kill_new(int i)
 	 */
     if (!rf_has(r_ptr->flags, RF_PASS_WALL))
     {
-		borg_grids[kill->y][kill->x].feat = FEAT_FLOOR;
+		borg_set_feat(&borg_grids[kill->y][kill->x], FEAT_FLOOR);
 	}
 
 	/* Hack -- Force the ghostly monster to be in a wall
@@ -1110,7 +1193,7 @@ static void borg_update_kill_new(int i)
 	 */
     if (rf_has(r_ptr->flags, RF_PASS_WALL))
     {
-		borg_grids[kill->y][kill->x].feat = FEAT_WALL_EXTRA;
+		borg_set_feat(&borg_grids[kill->y][kill->x], FEAT_WALL_EXTRA);
 	}
 
 }
@@ -1200,27 +1283,27 @@ static void borg_update_kill_old(int i)
     kill->moves = (t * e) / 10;
 
 	/* Preload the spells from the race into this individual monster */
-	kill->spell_flags[0] = r_ptr->spell_flags[0];
-	kill->spell_flags[1] = r_ptr->spell_flags[1];
-	kill->spell_flags[2] = r_ptr->spell_flags[2];
+	borg_kill_spells[i].spell_flags[0] = r_ptr->spell_flags[0];
+	borg_kill_spells[i].spell_flags[1] = r_ptr->spell_flags[1];
+	borg_kill_spells[i].spell_flags[2] = r_ptr->spell_flags[2];
 
 	/* Can it attack from a distance? */
     /* Extract the "inate" spells */
     for (k = 0; k < 32; k++)
     {
-        if (r_ptr->spell_flags[0] & (1L << k)) kill->spell[num++] = k + 32;
+        if (r_ptr->spell_flags[0] & (1L << k)) borg_kill_spells[i].spell[num++] = k + 32;
     }
 
     /* Extract the "normal" spells */
     for (k = 0; k < 32; k++)
     {
-        if (r_ptr->spell_flags[1] & (1L << k)) kill->spell[num++] = k + 32 * 2;
+        if (r_ptr->spell_flags[1] & (1L << k)) borg_kill_spells[i].spell[num++] = k + 32 * 2;
     }
 
     /* Extract the "bizarre" spells */
     for (k = 0; k < 32; k++)
     {
-        if (r_ptr->spell_flags[2] & (1L << k)) kill->spell[num++] = k + 32 * 3;
+        if (r_ptr->spell_flags[2] & (1L << k)) borg_kill_spells[i].spell[num++] = k + 32 * 3;
     }
 
 	/* Store the number of ranged attacks */
@@ -1252,7 +1335,7 @@ static void borg_update_kill_old(int i)
 	 */
 	if (!rf_has(r_ptr->flags, RF_PASS_WALL))
 	{
-		borg_grids[kill->y][kill->x].feat = FEAT_FLOOR;
+		borg_set_feat(&borg_grids[kill->y][kill->x], FEAT_FLOOR);
 	}
 
 	/* Hack -- Force the ghostly monster to be in a wall
@@ -1260,9 +1343,71 @@ static void borg_update_kill_old(int i)
 	 */
 	if (rf_has(r_ptr->flags, RF_PASS_WALL))
 	{
-		borg_grids[kill->y][kill->x].feat = FEAT_WALL_EXTRA;
+		borg_set_feat(&borg_grids[kill->y][kill->x], FEAT_WALL_EXTRA);
 	}
 
+	/* Recalculate danger near the monster */
+	borg_danger_forget(i);
+}
+
+
+/*
+ * Forget every "kill" record, as borg_forget_takes() does for objects
+ */
+void borg_forget_kills(void)
+{
+    /* Forget old monsters */
+    C_WIPE(borg_kills, borg_kills_nxt, borg_kill);
+    C_WIPE(borg_kill_spells, borg_kills_nxt, borg_kill_spell);
+    borg_cell_wipe(&borg_kill_cells);
+
+    /* No monsters here */
+    borg_kills_cnt = 0;
+    borg_kills_nxt = 1;
+    borg_kills_live_n = 0;
+}
+
+
+/*
+ * Add a kill index to the (sorted) list of live kills
+ */
+static void borg_live_kill_add(int i)
+{
+    int n;
+
+    /* Shift the later entries up */
+    for (n = borg_kills_live_n; (n > 0) && (borg_kills_live[n-1] > i); n--)
+    {
+        borg_kills_live[n] = borg_kills_live[n-1];
+    }
+
+    /* Insert */
+    borg_kills_live[n] = i;
+    borg_kills_live_n++;
+}
+
+
+/*
+ * Remove a kill index from the list of live kills
+ */
+static void borg_live_kill_del(int i)
+{
+    int n;
+
+    /* Find the entry */
+    for (n = 0; n < borg_kills_live_n; n++)
+    {
+        if (borg_kills_live[n] == i) break;
+    }
+
+    /* Paranoia -- not listed */
+    if (n == borg_kills_live_n) return;
+
+    /* Shift the later entries down */
+    for (borg_kills_live_n--; n < borg_kills_live_n; n++)
+    {
+        borg_kills_live[n] = borg_kills_live[n+1];
+    }
 }
 
 
@@ -1286,6 +1431,10 @@ void borg_delete_kill(int i)
 
 	/* Update the grids */
     borg_grids[kill->y][kill->x].kill = 0;
+    borg_cell_del(&borg_kill_cells, i, kill->y, kill->x);
+
+    /* Recalculate danger near the monster */
+    borg_danger_forget(i);
 
     /* save a time stamp of when the last multiplier was killed */
     if (rf_has(r_info[kill->r_idx].flags, RF_MULTIPLY))
@@ -1293,9 +1442,11 @@ void borg_delete_kill(int i)
 
     /* Kill the monster */
     WIPE(kill, borg_kill);
+    WIPE(&borg_kill_spells[i], borg_kill_spell);
 
     /* One less monster */
     borg_kills_cnt--;
+    borg_live_kill_del(i);
 
     /* Recalculate danger */
     borg_danger_wipe = TRUE;
@@ -1322,6 +1473,9 @@ static void borg_sleep_kill(int i)
     /* note sleep */
     kill->awake = FALSE;
 
+    /* Recalculate danger near the monster */
+    borg_danger_forget(i);
+
     /* Wipe flow goals */
     goal = 0;
 
@@ -1574,6 +1728,10 @@ static void borg_follow_kill(int i)
 
     /* Update the grids */
     borg_grids[kill->y][kill->x].kill = i;
+    borg_cell_move(&borg_kill_cells, i, oy, ox, kill->y, kill->x);
+
+    /* Recalculate danger near the monster */
+    borg_danger_forget(i);
 
     /* Note */
     borg_note(format("# Following a monster '%s' to (%d,%d) from (%d,%d)",
@@ -1613,6 +1771,10 @@ static int borg_new_kill(int r_idx, int y, int x)
     {
         /* Acquire the entry, advance */
         n = borg_kills_nxt++;
+
+        /* Start clean */
+        WIPE(&borg_kills[n], borg_kill);
+        WIPE(&borg_kill_spells[n], borg_kill_spell);
     }
 
     /* Hack -- steal an old monster */
@@ -1622,7 +1784,7 @@ static int borg_new_kill(int r_idx, int y, int x)
         borg_note("# Too many monsters");
 
         /* Hack -- Pick a random monster */
-        n = randint1(borg_kills_nxt-1) + 1;
+        n = randint0(borg_kills_nxt-1) + 1;
 
         /* Kill it */
         borg_delete_kill(n);
@@ -1631,6 +1793,7 @@ static int borg_new_kill(int r_idx, int y, int x)
 
     /* Count the monsters */
     borg_kills_cnt++;
+    borg_live_kill_add(n);
 
     /* Access the monster */
     kill = &borg_kills[n];
@@ -1646,6 +1809,7 @@ static int borg_new_kill(int r_idx, int y, int x)
 
     /* Update the grids */
     borg_grids[kill->y][kill->x].kill = n;
+    borg_cell_add(&borg_kill_cells, n, y, x);
 
     /* Timestamp */
     kill->when = borg_t;
@@ -1675,7 +1839,7 @@ static int borg_new_kill(int r_idx, int y, int x)
 	 */
     if (!(rf_has(r_ptr->flags, RF_PASS_WALL)))
     {
-		ag->feat = FEAT_FLOOR;
+		borg_set_feat(ag, FEAT_FLOOR);
 	}
 
 	/* Hack -- Force the ghostly monster to be in a wall
@@ -1683,7 +1847,7 @@ static int borg_new_kill(int r_idx, int y, int x)
 	 */
     if (rf_has(r_ptr->flags, RF_PASS_WALL))
     {
-		ag->feat = FEAT_WALL_EXTRA;
+		borg_set_feat(ag, FEAT_WALL_EXTRA);
 	}
 
 	/* Count up out list of Nasties */
@@ -1843,6 +2007,7 @@ static bool observe_kill_move(int y, int x, int d, byte a, char c, bool flag)
 
             /* Update the grids */
             borg_grids[kill->y][kill->x].kill = i;
+            borg_cell_move(&borg_kill_cells, i, oy, ox, y, x);
 
             /* Note */
             borg_note(format("# Tracking a monster '%s' at (%d,%d) from (%d,%d)",
@@ -2398,10 +2563,12 @@ static int borg_fear_spell(int i)
  */
 static int borg_locate_kill(cptr who, int y, int x, int r)
 {
-    int i, d, r_idx;
+    int i, k, n, d, r_idx;
 
     int b_i, b_d;
 
+    byte list[256];
+
     borg_take *take;
     borg_kill *kill;
 
@@ -2473,14 +2640,13 @@ static int borg_locate_kill(cptr who, int y, int x, int r)
     /* Nothing yet */
     b_i = -1; b_d = 999;
 
-    /* Scan the objects */
-    for (i = 1; i < borg_takes_nxt; i++)
+    /* Scan the objects near the grid */
+    n = borg_cell_query(&borg_take_cells, y, x, r, list);
+    for (k = 0; k < n; k++)
     {
+        i = list[k];
         take = &borg_takes[i];
 
-        /* Skip "dead" objects */
-        if (!take->k_idx) continue;
-
         /* Access kind */
         k_ptr = &k_info[take->k_idx];
 
@@ -2558,14 +2724,13 @@ static int borg_locate_kill(cptr who, int y, int x, int r)
     /* Nothing yet */
     b_i = -1; b_d = 999;
 
-    /* Scan the monsters */
-    for (i = 1; i < borg_kills_nxt; i++)
+    /* Scan the monsters near the grid */
+    n = borg_cell_query(&borg_kill_cells, y, x, r, list);
+    for (k = 0; k < n; k++)
     {
+        i = list[k];
         kill = &borg_kills[i];
 
-        /* Skip "dead" monsters */
-        if (!kill->r_idx) continue;
-
         /* Skip "matching" monsters */
         if (kill->r_idx == r_idx) continue;
 
@@ -2632,14 +2797,13 @@ static int borg_locate_kill(cptr who, int y, int x, int r)
     /* Nothing yet */
     b_i = -1; b_d = 999;
 
-    /* Scan the monsters */
-    for (i = 1; i < borg_kills_nxt; i++)
+    /* Scan the monsters near the grid */
+    n = borg_cell_query(&borg_kill_cells, y, x, r + 3, list);
+    for (k = 0; k < n; k++)
     {
+        i = list[k];
         kill = &borg_kills[i];
 
-        /* Skip "dead" monsters */
-        if (!kill->r_idx) continue;
-
         /* Skip "different" monsters */
         if (kill->r_idx != r_idx) continue;
 
@@ -2672,14 +2836,13 @@ static int borg_locate_kill(cptr who, int y, int x, int r)
 	    /* Nothing yet */
 		b_i = -1; b_d = 999;
 
-	    /* Scan the monsters */
-	    for (i = 1; i < borg_kills_nxt; i++)
+	    /* Scan the monsters near the grid */
+	    n = borg_cell_query(&borg_kill_cells, y, x, r + 20, list);
+	    for (k = 0; k < n; k++)
 	    {
+	        i = list[k];
 	        kill = &borg_kills[i];
 
-	        /* Skip "dead" monsters */
-	        if (!kill->r_idx) continue;
-
 	        /* Skip "different" monsters */
 	        if (kill->r_idx != r_idx) continue;
 
@@ -2944,6 +3107,28 @@ static bool borg_handle_self(cptr str)
 
 
 
+/*
+ * Change the feature of a known grid.  Cached flows and projections
+ * saw the old feature, and the danger map saw the old walls.
+ */
+void borg_set_feat(borg_grid *ag, byte feat)
+{
+    bool old_wall = !borg_cave_floor_grid(ag);
+
+    /* Nothing new */
+    if (ag->feat == feat) return;
+
+    /* Save it */
+    ag->feat = feat;
+
+    /* Cached flows and projections are stale */
+    borg_flow_epoch++;
+
+    /* So is the danger map, if a wall came or went */
+    if (old_wall != !borg_cave_floor_grid(ag)) borg_danger_wipe_map();
+}
+
+
 /*
  * Update the Borg based on the current "map"
  */
@@ -3000,6 +3185,8 @@ static void borg_forget_map(void)
     /* Clear "borg_data_icky" */
     WIPE(borg_data_icky, borg_data);
 
+    /* Cached flows and projections saw the old map */
+    borg_flow_epoch++;
 
     /* Forget the view */
     borg_forget_view();
@@ -3097,6 +3284,13 @@ static byte Get_f_info_number[256];
  * nasty situations in which we attempt to flow into a wall grid
  * which was thought to be something else, like an unknown grid.
  *
+ * We remember the glyph each grid showed the last time we looked at
+ * it, and what we left in its "feat" and "info".  A grid whose glyph
+ * and memory are both unchanged would come out the same again, so it
+ * is skipped, unless it is in view (we cheat features from the game
+ * there), holds the player, or showed a monster or object (those are
+ * tracked again every turn).  If somebody else changed the tracking
+ * lists, the whole panel is looked at again.
  */
 static void borg_update_map(void)
 {
@@ -3106,6 +3300,20 @@ static void borg_update_map(void)
 	grid_data g;
     byte t_a;
     byte t_c;
+    byte r_a;
+    byte r_c;
+
+    bool full;
+    bool low = (borg_skill[BI_CLEVEL] <= 5);
+
+    /* Rescan everything if the tracking lists moved under us */
+    full = (!borg_map_ready ||
+            borg_map_low != low ||
+            borg_map_less != track_less_num ||
+            borg_map_more != track_more_num ||
+            borg_map_glyph != track_glyph_num ||
+            borg_map_closed != track_closed_num ||
+            borg_map_vein != track_vein_num);
 
     /* Analyze the current map panel */
     for (dy = 0; dy < SCREEN_HGT; dy++)
@@ -3125,19 +3333,52 @@ static void borg_update_map(void)
         {
             bool old_wall;
             bool new_wall;
+            byte old_feat;
 
 
             /* Obtain the map location */
             x = w_x + dx;
             y = w_y + dy;
 
+            /* Save contents */
+            t_a = r_a = *aa++;
+            t_c = r_c = *cc++;
+
+            /* Get the borg_grid */
+            ag = &borg_grids[y][x];
+
+            /* Count it */
+            borg_map_cells++;
+
+            /* New glyph */
+            if (r_a != borg_map_a[y][x] || r_c != borg_map_c[y][x])
+            {
+                borg_map_changed++;
+            }
+
+            /* Nothing to learn here */
+            else if (!full &&
+                     !borg_map_wank[y][x] &&
+                     !(y == c_y && x == c_x) &&
+                     ag->feat == borg_map_feat[y][x] &&
+                     (ag->info & BORG_MAP_INFO) == borg_map_info[y][x] &&
+                     !player_can_see_bold(y, x))
+            {
+                continue;
+            }
+
+            /* Examine it */
+            borg_map_examined++;
+            borg_map_a[y][x] = r_a;
+            borg_map_c[y][x] = r_c;
+            borg_map_wank[y][x] = FALSE;
+
+            /* Save the old feature */
+            old_feat = ag->feat;
+
 			/* Cheat the exact information from the screen */
 			map_info(y, x, &g);
 
-            /* Save contents */
-            t_a = *aa++;
-            t_c = *cc++;
-
 #ifdef ALLOW_BORG_GRAPHICS
 
            /* Translate the glyph into an ASCII char */
@@ -3153,9 +3394,6 @@ static void borg_update_map(void)
 #endif /* ALLOW_BORG_GRAPHICS */
 
 
-            /* Get the borg_grid */
-            ag = &borg_grids[y][x];
-
             /* Notice "on-screen" */
             ag->info |= BORG_OKAY;
 
@@ -3625,6 +3863,9 @@ static void borg_update_map(void)
                     /* Access next wank, advance */
                     wank = &borg_wanks[borg_wank_num++];
 
+                    /* Look again next turn */
+                    borg_map_wank[y][x] = TRUE;
+
                     /* Save some information */
                     wank->x = x;
                     wank->y = y;
@@ -3676,14 +3917,33 @@ static void borg_update_map(void)
                 /* Remove this grid from any flow */
                 borg_data_icky->data[y][x] = FALSE;
 
+                /* Cached danger saw the old grid */
+                borg_danger_wipe_map();
+
                 /* Recalculate the view (if needed) */
                 if (ag->info & BORG_VIEW) borg_do_update_view = TRUE;
 
                 /* Recalculate the lite (if needed) */
                 if (ag->info & BORG_LIGHT) borg_do_update_LIGHT = TRUE;
             }
+
+            /* Cached flows and projections saw the old grid */
+            if (ag->feat != old_feat) borg_flow_epoch++;
+
+            /* Remember what we left */
+            borg_map_feat[y][x] = ag->feat;
+            borg_map_info[y][x] = (ag->info & BORG_MAP_INFO);
         }
     }
+
+    /* Remember the tracking lists */
+    borg_map_ready = TRUE;
+    borg_map_low = low;
+    borg_map_less = track_less_num;
+    borg_map_more = track_more_num;
+    borg_map_glyph = track_glyph_num;
+    borg_map_closed = track_closed_num;
+    borg_map_vein = track_vein_num;
 }
 
 
@@ -3755,6 +4015,10 @@ void borg_update(void)
 	int floor_glyphed = 0;
 	bool monster_in_vault = FALSE;
 
+    /* Cached flows and danger are only good for one turn */
+    borg_flow_epoch++;
+    borg_danger_wipe_map();
+
     /*** Process objects/monsters ***/
 
     /* Scan monsters */
@@ -4208,7 +4472,7 @@ void borg_update(void)
 		        /* Mark known floor grids as trap */
 		        if (borg_cave_floor_grid(ag))
 		        {
-					ag->feat = FEAT_TRAP_HEAD;
+					borg_set_feat(ag, FEAT_TRAP_HEAD);
 
 					/* Leave a note */
 					borg_note(format("# Assuming a Traps at (%d,%d).",y,x));
@@ -4351,6 +4615,9 @@ void borg_update(void)
             }
         }
 
+        /* Forget the danger that came with it */
+        borg_danger_wipe_map();
+
         /* Hack -- Clear "shop visit" stamps */
         for (i = 0; i < MAX_STORES; i++) borg_shops[i].when = 0;
 
@@ -4408,15 +4675,10 @@ void borg_update(void)
 		track_worn_num =0;
 
         /* No objects here */
-        borg_takes_cnt = 0;
-        borg_takes_nxt = 1;
-
-        /* Forget old objects */
-        C_WIPE(borg_takes, 256, borg_take);
+        borg_forget_takes();
 
         /* No monsters here */
-        borg_kills_cnt = 0;
-        borg_kills_nxt = 1;
+        borg_forget_kills();
 
 		/* Hack- Assume that Morgoth is on Level 100 unless
 		 * we know he is dead
@@ -4442,9 +4704,6 @@ void borg_update(void)
 			if (borg_nasties[i] == 'Z') borg_nasties_count[i] = 25; /* Assume some on level */
 		}
 
-        /* Forget old monsters */
-        C_WIPE(borg_kills, 256, borg_kill);
-
         /* Hack -- Forget race counters */
         C_WIPE(borg_race_count, z_info->r_max, s16b);
 
@@ -4637,6 +4896,9 @@ void borg_update(void)
             }
         }
 
+        /* Forget the danger that came with it */
+        borg_danger_wipe_map();
+
         /* Handle changing map panel */
         if ((o_w_x != w_x) || (o_w_y != w_y))
         {
@@ -4781,7 +5043,7 @@ void borg_update(void)
         if (rf_has(r_info[kill->r_idx].flags, RF_PASS_WALL)) continue;
 
 		/* Make sure this grid keeps Floor grid */
-		borg_grids[kill->y][kill->x].feat = FEAT_FLOOR;
+		borg_set_feat(&borg_grids[kill->y][kill->x], FEAT_FLOOR);
     }
 
 	/* Let me know if I am correctly positioned for special
@@ -5442,6 +5704,17 @@ void borg_init_5(void)
     for (i = 0; i < size; i++) borg_normal_text[i] = text[i];
     for (i = 0; i < size; i++) borg_normal_what[i] = what[i];
 
+
+    /*** Hash the monster names ***/
+
+    /* At least four slots per race */
+    for (borg_name_hash_mask = 1; borg_name_hash_mask < z_info->r_max * 4;
+         borg_name_hash_mask <<= 1) /* loop */;
+    borg_name_hash_mask--;
+
+    borg_name_hash_make(&borg_unique_hash, borg_unique_text, borg_unique_size);
+    borg_name_hash_make(&borg_normal_hash, borg_normal_text, borg_normal_size);
+
    /* Initialize */
    for (i = 0; i < 256; i++) Get_f_info_number[i] = -1;
 
@@ -31,6 +31,13 @@ extern void borg_update(void);
 extern void borg_react(cptr msg, cptr buf);
 extern void borg_delete_kill(int i);
 extern void borg_delete_take(int i);
+extern void borg_forget_kills(void);
+extern void borg_forget_takes(void);
+
+/*
+ * Change the feature of a grid, staling the caches that saw it
+ */
+extern void borg_set_feat(borg_grid *ag, byte feat);
 
 
 /*
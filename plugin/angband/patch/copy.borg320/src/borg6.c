@@ -162,6 +162,93 @@ static int borg_goto_dir(int y1, int x1, int y2, int x2)
 
 
 
+/*
+ * Flow cache -- the last few flow fields, keyed by everything that
+ * "borg_flow_spread()" reads.  Several goals often flow towards the
+ * same grids during one turn (stairs in particular), and the spread
+ * is by far the most expensive part of a flow.
+ *
+ * The "epoch" is bumped whenever the map or the monster list changes
+ * (see "borg_update()" and "borg_update_map()"), whenever the danger
+ * flags are wiped, and whenever the "know"/"icky" flags are edited by
+ * hand, so a stale field can never match.  The goal set is summarized
+ * by a hash of the enqueued grids, built up by "borg_flow_enqueue_grid()".
+ * Flows which write the "cost" field directly are never cached.
+ */
+#define BORG_FLOW_CACHE_MAX 8
+
+typedef struct borg_flow_key borg_flow_key;
+
+struct borg_flow_key
+{
+    u32b epoch;         /* Map/danger epoch */
+    u32b goal_hash;     /* Hash of the enqueued grids */
+    s32b goal_num;      /* Number of enqueued grids */
+    s32b depth;         /* Spread depth */
+    s32b flags;         /* Spread flags and relevant borg state */
+    s32b origin_y;      /* Grid the "optimize" check looks at */
+    s32b origin_x;
+    s32b c_y;           /* Player grid (shop entrances) */
+    s32b c_x;
+    s32b goal_shop;
+    s32b avoidance;
+    s32b skill[5];      /* CURHP, DIS, CLEVEL, MAXCLEVEL, FOOD */
+};
+
+static borg_flow_key flow_goals;    /* Goal set of the flow being built */
+static bool flow_cacheable;         /* Flow being built may be cached */
+
+static borg_flow_key flow_cache_key[BORG_FLOW_CACHE_MAX];
+static borg_data *flow_cache_data[BORG_FLOW_CACHE_MAX];
+static int flow_cache_num = 0;
+static int flow_cache_next = 0;
+
+/*
+ * Fill in everything but the goal set of a flow cache key, for a
+ * "borg_flow_spread()" with the given arguments.
+ */
+static void borg_flow_key_make(borg_flow_key *key, int depth, bool optimize, bool avoid, bool tunneling, int stair_idx, bool sneak)
+{
+	int origin_y = c_y, origin_x = c_x;
+	bool twitchy = (avoidance > borg_skill[BI_CURHP]);
+
+	/* See "borg_flow_spread()" */
+	if (stair_idx >= 0 && borg_skill[BI_CLEVEL] < 15)
+	{
+		origin_y = track_less_y[stair_idx];
+		origin_x = track_less_x[stair_idx];
+		optimize = FALSE;
+	}
+
+	key->epoch = borg_flow_epoch;
+	key->depth = depth;
+	key->flags = (optimize ? 0x0001 : 0) |
+	             (avoid ? 0x0002 : 0) |
+	             (tunneling ? 0x0004 : 0) |
+	             (sneak ? 0x0008 : 0) |
+	             (twitchy ? 0x0010 : 0) |
+	             (borg_desperate ? 0x0020 : 0) |
+	             (borg_lunal_mode ? 0x0040 : 0) |
+	             (borg_munchkin_mode ? 0x0080 : 0) |
+	             (scaryguy_on_level ? 0x0100 : 0) |
+	             (unique_on_level ? 0x0200 : 0) |
+	             (vault_on_level ? 0x0400 : 0) |
+	             (goal_ignoring ? 0x0800 : 0) |
+	             ((borg_t - borg_began > 5000) ? 0x1000 : 0);
+	key->origin_y = origin_y;
+	key->origin_x = origin_x;
+	key->c_y = c_y;
+	key->c_x = c_x;
+	key->goal_shop = goal_shop;
+	key->avoidance = avoidance;
+	key->skill[0] = borg_skill[BI_CURHP];
+	key->skill[1] = borg_skill[BI_DIS];
+	key->skill[2] = borg_skill[BI_CLEVEL];
+	key->skill[3] = borg_skill[BI_MAXCLEVEL];
+	key->skill[4] = borg_skill[BI_FOOD];
+}
+
+
 /*
  * Clear the "flow" information
  *
@@ -184,11 +271,19 @@ static void borg_flow_clear(void)
 
         /* Wipe complete */
         borg_danger_wipe = FALSE;
+
+        /* Cached flows used the old flags */
+        borg_flow_epoch++;
     }
 
     /* Start over */
     flow_head = 0;
     flow_tail = 0;
+
+    /* No goals yet */
+    flow_goals.goal_hash = 2166136261UL;
+    flow_goals.goal_num = 0;
+    flow_cacheable = TRUE;
 }
 
 
@@ -273,6 +368,9 @@ static void borg_flow_spread(int depth, bool optimize, bool avoid, bool tunnelin
 	bool bad_sneak = FALSE;
 	int origin_y, origin_x;
 	bool twitchy = FALSE;
+	borg_flow_key key;
+
+	BORG_PROF_ENTER(BORG_PROF_SPREAD);
 
 	/* Default starting points */
 	origin_y = c_y;
@@ -289,6 +387,33 @@ static void borg_flow_spread(int depth, bool optimize, bool avoid, bool tunnelin
 		optimize = FALSE;
 	}
 
+	/* Build the cache key */
+	if (flow_cacheable)
+	{
+		key = flow_goals;
+		borg_flow_key_make(&key, depth, optimize, avoid, tunneling, stair_idx, sneak);
+
+		/* Look for the same flow */
+		for (i = 0; i < flow_cache_num; i++)
+		{
+			if (memcmp(&flow_cache_key[i], &key, sizeof(key))) continue;
+
+			/* Reuse it */
+			COPY(borg_data_cost, flow_cache_data[i], borg_data);
+
+			/* Forget the queue */
+			flow_head = flow_tail = 0;
+			flow_cacheable = FALSE;
+
+			borg_flow_hits++;
+			BORG_PROF_LEAVE(BORG_PROF_SPREAD);
+			return;
+		}
+	}
+
+	/* Count it */
+	borg_flow_builds++;
+
     /* Now process the queue */
     while (flow_head != flow_tail)
     {
@@ -478,6 +603,22 @@ static void borg_flow_spread(int depth, bool optimize, bool avoid, bool tunnelin
 
     /* Forget the flow info */
     flow_head = flow_tail = 0;
+
+    /* Remember the flow */
+    if (flow_cacheable)
+    {
+        i = flow_cache_next;
+        flow_cache_key[i] = key;
+        COPY(flow_cache_data[i], borg_data_cost, borg_data);
+
+        if (flow_cache_num < BORG_FLOW_CACHE_MAX) flow_cache_num++;
+        if (++flow_cache_next == BORG_FLOW_CACHE_MAX) flow_cache_next = 0;
+    }
+
+    /* Spread again only after a clear */
+    flow_cacheable = FALSE;
+
+    BORG_PROF_LEAVE(BORG_PROF_SPREAD);
 }
 
 
@@ -538,6 +679,11 @@ static void borg_flow_enqueue_grid(int y, int x)
     /* Save the flow cost (zero) */
     borg_data_cost->data[y][x] = 0;
 
+    /* Add it to the goal set (FNV-1a) */
+    flow_goals.goal_hash = (flow_goals.goal_hash ^ (u32b)y) * 16777619UL;
+    flow_goals.goal_hash = (flow_goals.goal_hash ^ (u32b)x) * 16777619UL;
+    flow_goals.goal_num++;
+
     /* Enqueue that entry */
     borg_flow_y[flow_head] = y;
     borg_flow_x[flow_head] = x;
@@ -554,27 +700,51 @@ static void borg_flow_enqueue_grid(int y, int x)
 }
 
 
+/*
+ * Stair field -- the distance of every grid from one stair.  The
+ * exploration scans ask this for each candidate grid, always about
+ * the same stair, so the field is spread once and kept until the
+ * stair, the flow epoch or anything else in the flow key changes.
+ */
+static borg_data *borg_data_stair;
+static borg_flow_key stair_key;
+static bool stair_known = FALSE;
+
 /* Do a Stair-Flow.  Look at how far away this grid is to my closest stair */
-static borg_flow_cost_stair(int y, int x, int b_stair)
+int borg_flow_cost_stair(int y, int x, int b_stair)
 {
-	int cost = 255;
-
-    /* Clear the flow codes */
-    borg_flow_clear();
+	borg_flow_key key;
 
 	/* Paranoid */
 	if (b_stair == -1) return (0);
 
-    /* Enqueue the player's grid */
-    borg_flow_enqueue_grid(track_less_y[b_stair],track_less_x[b_stair]);
+	/* The stair is the only goal */
+	WIPE(&key, borg_flow_key);
+	key.goal_hash = (u32b)(track_less_y[b_stair] << 8 | track_less_x[b_stair]);
+	key.goal_num = b_stair;
+	borg_flow_key_make(&key, 250, FALSE, FALSE, FALSE, b_stair, FALSE);
 
-    /* Spread, but do NOT optimize */
-    borg_flow_spread(250, FALSE, FALSE, FALSE, b_stair, FALSE);
+	/* Spread the field (only when stale) */
+	if (!stair_known || borg_danger_wipe || memcmp(&key, &stair_key, sizeof(key)))
+	{
+	    /* Clear the flow codes */
+	    borg_flow_clear();
 
-	/* Distance from the grid to the stair */
-	cost = borg_data_cost->data[y][x];
+	    /* Enqueue the player's grid */
+	    borg_flow_enqueue_grid(track_less_y[b_stair],track_less_x[b_stair]);
+
+	    /* Spread, but do NOT optimize */
+	    borg_flow_spread(250, FALSE, FALSE, FALSE, b_stair, FALSE);
 
-	return (cost);
+	    /* Keep it (the clear may have moved the epoch) */
+	    COPY(borg_data_stair, borg_data_cost, borg_data);
+	    key.epoch = borg_flow_epoch;
+	    stair_key = key;
+	    stair_known = TRUE;
+	}
+
+	/* Distance from the grid to the stair */
+	return (borg_data_stair->data[y][x]);
 }
 
 
@@ -758,14 +928,11 @@ static bool borg_surrounded(void)
     int i;
 
     /* Evaluate the local monsters */
-    for (i = 1; i < borg_kills_nxt; i++)
+    for (i = 0; i < borg_kills_live_n; i++)
     {
-        kill = &borg_kills[i];
+        kill = &borg_kills[borg_kills_live[i]];
         r_ptr = &r_info[kill->r_idx];
 
-        /* Skip dead monsters */
-        if (!kill->r_idx) continue;
-
         x9 = kill->x;
         y9 = kill->y;
 
@@ -1244,7 +1411,7 @@ void borg_near_monster_type(int dist)
     monster_race *r_ptr;
 
     int x9, y9, ax, ay, d;
-    int i;
+    int i, n;
 	int breeder_count = 0;
 
     /* reset the borg flags */
@@ -1255,14 +1422,12 @@ void borg_near_monster_type(int dist)
 
 
     /* Scan the monsters */
-    for (i = 1; i < borg_kills_nxt; i++)
+    for (n = 0; n < borg_kills_live_n; n++)
     {
+        i = borg_kills_live[n];
         kill = &borg_kills[i];
         r_ptr = &r_info[kill->r_idx];
 
-        /* Skip dead monsters */
-        if (!kill->r_idx) continue;
-
 
 		/* Count breeders */
 		if (rf_has(r_ptr->flags, RF_MULTIPLY)) breeder_count ++;
@@ -1424,83 +1589,261 @@ void borg_near_monster_type(int dist)
 }
 
 /*
- * Help determine if "phase door" seems like a good idea
+ * Landing tables -- where a phase door or a teleport can put the borg.
+ *
+ * The game picks spots uniformly from the square around the player,
+ * keeps the ones at the right distance, and takes the first of up to
+ * 100 that it likes.  So a jump lands uniformly on one of the grids it
+ * likes, unless all 100 spots are rejected, which happens with chance
+ * (1 - liked/ring)^100 where "ring" counts every spot at the right
+ * distance, on the map or not.
+ *
+ * Each table lists the liked grids with their danger, so the checks
+ * below give the expected number of bad landings out of 100 instead
+ * of rolling 100 jumps.  A table is rebuilt when the borg moves, the
+ * number of turns changes, or the flow, monster or danger epoch moves
+ * on.
+ *
+ * A phase door ring holds at most a few hundred grids, and all of them
+ * are looked at.  A teleport can like thousands, so only an even spread
+ * of BORG_LAND_SAMPLE of them is asked for its danger; the spread is
+ * the same every time, so the answer does not jitter between calls.
  */
-bool borg_caution_phase(int emergency, int turns)
+#define BORG_LAND_PHASE     0
+#define BORG_LAND_SCOOT     1
+#define BORG_LAND_TELEPORT  2
+#define BORG_LAND_MAX       3
+
+#define BORG_LAND_SAMPLE    512     /* Liked grids looked at, at most */
+
+typedef struct borg_landing borg_landing;
+
+struct borg_landing
+{
+    bool ready;
+
+    int y, x;               /* Borg location */
+    int turns;              /* Turns of danger */
+    bool unknown_ok;        /* Unknown grids are liked */
+    u32b flow_epoch;
+    u32b kill_epoch;
+    u32b danger_epoch;
+
+    s32b ring;              /* Spots at the right distance */
+    s32b liked;             /* Grids the game likes */
+    int num;                /* Liked grids looked at */
+
+    s16b danger[BORG_LAND_SAMPLE];
+    byte adjacent[BORG_LAND_SAMPLE];    /* Awake monsters next to it */
+    byte unknown[BORG_LAND_SAMPLE];
+};
+
+static borg_landing *borg_landings;
+
+
+/*
+ * Would the game let a jump land here?
+ */
+static bool borg_landing_liked(int y, int x, int edge, bool unknown_ok)
+{
+    borg_grid *ag;
+
+    /* Ignore illegal locations */
+    if ((y <= 0) || (y >= AUTO_MAX_Y - edge)) return (FALSE);
+    if ((x <= 0) || (x >= AUTO_MAX_X - edge)) return (FALSE);
+
+    /* Access */
+    ag = &borg_grids[y][x];
+
+    /* Skip unknown grids */
+    if (ag->feat == FEAT_NONE && !unknown_ok) return (FALSE);
+
+    /* Skip weird grids */
+    if (ag->feat == FEAT_INVIS) return (FALSE);
+
+    /* Skip walls */
+    if (!borg_cave_floor_bold(y, x)) return (FALSE);
+
+    /* Skip monsters */
+    if (ag->kill) return (FALSE);
+
+    return (TRUE);
+}
+
+
+/*
+ * Fill in (or reuse) the landing table for one kind of jump
+ */
+static borg_landing *borg_landing_table(int kind, int turns)
 {
-    int n, k, i, d, x, y, p;
+    borg_landing *t = &borg_landings[kind];
+
+    int y, x, d, u;
+    s32b n, next;
 
-    int dis = 10;
+    int dis = (kind == BORG_LAND_TELEPORT) ? 100 : 10;
     int min = dis / 2;
+    int edge = (kind == BORG_LAND_SCOOT) ? 2 : 1;
 
-    borg_grid *ag= &borg_grids[c_y][c_x];
+    bool unknown_ok = FALSE;
 
+    u32b danger_epoch = borg_danger_sync();
 
-	/* must have the ability */
-	if (!borg_skill[BI_APHASE]) return (FALSE);
+    borg_grid *ag;
+
+    /* Teleport takes unknown grids until the panel is explored */
+    if (kind == BORG_LAND_TELEPORT)
+    {
+        int q_x = w_x / PANEL_WID;
+        int q_y = w_y / PANEL_HGT;
+
+        unknown_ok = !((borg_detect_wall[q_y+0][q_x+0] == TRUE &&
+                        borg_detect_wall[q_y+0][q_x+1] == TRUE &&
+                        borg_detect_wall[q_y+1][q_x+0] == TRUE &&
+                        borg_detect_wall[q_y+1][q_x+1] == TRUE) ||
+                       borg_t > 2000);
+    }
+
+    /* Still good */
+    if (t->ready &&
+        t->y == c_y && t->x == c_x &&
+        t->turns == turns &&
+        t->unknown_ok == unknown_ok &&
+        t->flow_epoch == borg_flow_epoch &&
+        t->kill_epoch == borg_kill_epoch &&
+        t->danger_epoch == danger_epoch)
+    {
+        return (t);
+    }
+
+    t->ready = TRUE;
+    t->y = c_y;
+    t->x = c_x;
+    t->turns = turns;
+    t->unknown_ok = unknown_ok;
+    t->flow_epoch = borg_flow_epoch;
+    t->kill_epoch = borg_kill_epoch;
+    t->danger_epoch = danger_epoch;
+    t->ring = 0;
+    t->liked = 0;
+    t->num = 0;
 
-    /* Simulate 100 attempts */
-    for (n = k = 0; k < 100; k++)
+    /* Every spot the game might pick */
+    for (y = c_y - dis; y <= c_y + dis; y++)
     {
-        /* Pick a location */
-        for (i = 0; i < 100; i++)
+        for (x = c_x - dis; x <= c_x + dis; x++)
         {
-            /* Pick a (possibly illegal) location */
-            while (1)
-            {
-                y = rand_spread(c_y, dis);
-                x = rand_spread(c_x, dis);
-                d = distance(c_y, c_x, y, x);
-                if ((d >= min) && (d <= dis)) break;
-            }
+            d = distance(c_y, c_x, y, x);
+            if ((d < min) || (d > dis)) continue;
+
+            /* Count the spot */
+            t->ring++;
+
+            /* Count the grid */
+            if (borg_landing_liked(y, x, edge, unknown_ok)) t->liked++;
+        }
+    }
+
+    /* Look at every liked grid, or an even spread of them */
+    for (n = next = 0, y = c_y - dis; y <= c_y + dis; y++)
+    {
+        for (x = c_x - dis; x <= c_x + dis; x++)
+        {
+            if (t->num == BORG_LAND_SAMPLE) break;
+
+            d = distance(c_y, c_x, y, x);
+            if ((d < min) || (d > dis)) continue;
+
+            if (!borg_landing_liked(y, x, edge, unknown_ok)) continue;
 
-            /* Ignore illegal locations */
-            if ((y <= 0) || (y >= AUTO_MAX_Y - 1)) continue;
-            if ((x <= 0) || (x >= AUTO_MAX_X - 1)) continue;
+            /* Not one of the spread */
+            if (n++ != next) continue;
+            next = (t->liked <= BORG_LAND_SAMPLE) ? n :
+                   (s32b)((double)(t->num + 1) * t->liked / BORG_LAND_SAMPLE);
 
             /* Access */
             ag = &borg_grids[y][x];
 
-            /* Skip unknown grids */
-            if (ag->feat == FEAT_NONE) continue;
-
-            /* Skip weird grids */
-            if (ag->feat == FEAT_INVIS) continue;
+            /* Remember the grid */
+            t->danger[t->num] = borg_danger(y, x, turns, TRUE, FALSE);
+            t->unknown[t->num] = (ag->feat == FEAT_NONE);
+            t->adjacent[t->num] = 0;
 
-            /* Skip walls */
-            if (!borg_cave_floor_bold(y, x)) continue;
+            /* Awake monsters next to the grid (Shoot'N'Scoot only) */
+            if (kind == BORG_LAND_SCOOT)
+            {
+                for (u = 0; u < 8; u++)
+                {
+                    borg_grid *ag2 = &borg_grids[y+ddy_ddd[u]][x+ddx_ddd[u]];
 
-            /* Skip monsters */
-            if (ag->kill) continue;
+                    if (ag2->kill && borg_kills[ag2->kill].awake)
+                        t->adjacent[t->num]++;
+                }
+            }
 
-            /* Stop looking */
-            break;
+            t->num++;
         }
+    }
 
-        /* If low level, unknown squares are scary */
-        if (ag->feat == FEAT_NONE && borg_skill[BI_MAXHP] < 30)
-        {
-            n++;
-            continue;
-        }
+    return (t);
+}
 
-        /* No location */
-        /* in the real code it would keep trying but here we should */
-        /* assume that there is unknown spots that you would be able */
-        /* to go but may be dangerious. */
-        if (i >= 100)
-        {
-            n++;
-            continue;
-        }
 
-        /* Examine */
-        p = borg_danger(y, x, turns, TRUE, FALSE);
+/*
+ * Expected number of bad landings out of 100 jumps.
+ *
+ * A landing is bad if its danger is over "limit", or if it is unknown
+ * and the borg is still frail.  With "adjacent" set, a safe landing
+ * instead counts one for each awake monster next to it.
+ */
+static int borg_landing_scary(borg_landing *t, int limit, bool adjacent)
+{
+    int i;
+    double miss, bad;
+
+    /* Nowhere to go */
+    if (!t->num) return (100);
+
+    /* Chance that all 100 spots are rejected */
+    miss = 1.0;
+    for (i = 0; i < 100; i++)
+    {
+        miss *= 1.0 - (double)t->liked / (double)t->ring;
+    }
+
+    /* Count the bad landings */
+    for (bad = 0, i = 0; i < t->num; i++)
+    {
+        /* If low level, unknown squares are scary */
+        if (t->unknown[i] && borg_skill[BI_MAXHP] < 30) bad += 1;
 
-        /* if *very* scary, do not allow jumps at all */
-        if (p > borg_skill[BI_CURHP]) n++;
+        /* Scary */
+        else if (t->danger[i] > limit) bad += 1;
+
+        /* Monsters next to it */
+        else if (adjacent) bad += t->adjacent[i];
     }
 
+    return ((int)(100.0 * (miss + (1.0 - miss) * bad / t->num) + 0.5));
+}
+
+/*
+ * Help determine if "phase door" seems like a good idea
+ */
+bool borg_caution_phase(int emergency, int turns)
+{
+    int n;
+
+	/* must have the ability */
+	if (!borg_skill[BI_APHASE]) return (FALSE);
+
+    /* Expected scary landings out of 100.  In the real code it would */
+    /* keep trying when no spot is found, but here we assume that there */
+    /* are unknown spots that you would be able to go to but may be */
+    /* dangerous. */
+    n = borg_landing_scary(borg_landing_table(BORG_LAND_PHASE, turns),
+                           borg_skill[BI_CURHP], FALSE);
+
     /* Too much danger */
     /* in an emergency try with extra danger allowed */
     if  (n > emergency)
@@ -1538,11 +1881,7 @@ bool borg_caution_phase(int emergency, int turns)
  */
 bool borg_shoot_scoot_safe(int emergency, int turns, int b_p)
 {
-    int n, k, i, d, x, y, p, u;
-
- 	int dis = 10;
-
- 	int min = dis / 2;
+    int n, i, x, y;
 
 	bool adjacent_monster = FALSE;
 
@@ -1644,88 +1983,11 @@ bool borg_shoot_scoot_safe(int emergency, int turns, int b_p)
 	/* if No Adjacent_monster no need for it */
 	if (adjacent_monster == FALSE) return (FALSE);
 
-    /* Simulate 100 attempts */
-    for (n = k = 0; k < 100; k++)
-    {
-        /* Pick a location */
-        for (i = 0; i < 100; i++)
-        {
-            /* Pick a (possibly illegal) location */
-            while (1)
-            {
-                y = rand_spread(c_y, dis);
-                x = rand_spread(c_x, dis);
-                d = distance(c_y, c_x, y, x);
-                if ((d >= min) && (d <= dis)) break;
-            }
-
-            /* Ignore illegal locations */
-            if ((y <= 0) || (y >= AUTO_MAX_Y - 2)) continue;
-            if ((x <= 0) || (x >= AUTO_MAX_X - 2)) continue;
-
-            /* Access */
-            ag = &borg_grids[y][x];
-
-            /* Skip unknown grids */
-            if (ag->feat == FEAT_NONE) continue;
-
-            /* Skip weird grids */
-            if (ag->feat == FEAT_INVIS) continue;
-
-            /* Skip walls */
-            if (!borg_cave_floor_bold(y, x)) continue;
-
-            /* Skip monsters */
-            if (ag->kill) continue;
-
-
-            /* Stop looking.  Really, the game would keep
-             * looking for a grid.  The borg could check
-             * all the known grids but I dont think that
-             * is not a good idea, especially if the area is
-             * not fully explored.
-             */
-            break;
-        }
-
-        /* No location */
-        /* In the real code it would keep trying but here we should */
-        /* assume that there is unknown spots that you would be able */
-        /* to go but we define it as dangerous. */
-        if (i >= 100)
-        {
-            n++;
-            continue;
-        }
-
-        /* Examine danger of that grid */
-        p = borg_danger(y, x, turns, TRUE, FALSE);
-
-        /* if more scary than my current one, do not allow jumps at all */
-        if (p > b_p)
-        {
-			n++;
-			continue;
-		}
-
-		/* Should not land next to a monster either.
-	     * Scan the adjacent grids for a monster.
-	     * Reuse the adjacent_monster variable.
-	     */
-	    for (u = 0; u < 8; u++)
-	    {
-	        /* Access the grid */
-	        ag = &borg_grids[y+ddy_ddd[u]][x+ddx_ddd[u]];
-
-	        /* Obtain the monster */
-	        kill = &borg_kills[ag->kill];
-
-			/* If monster adjacent to that grid...
-			 */
-			if (ag->kill && kill->awake) n++;
-		}
-
-    }
+    /* Expected bad landings out of 100.  A landing is bad if it is */
+    /* more scary than my current grid, and we should not land next */
+    /* to a monster either. */
+    n = borg_landing_scary(borg_landing_table(BORG_LAND_SCOOT, turns),
+                           b_p, TRUE);
 
     /* Too much danger */
     /* in an emergency try with extra danger allowed */
@@ -1745,88 +2007,14 @@ bool borg_shoot_scoot_safe(int emergency, int turns, int b_p)
  */
 bool borg_caution_teleport(int emergency, int turns)
 {
-    int n, k, i, d, x, y, p;
-
-    int dis = 100;
-    int min = dis / 2;
-    int q_x, q_y;
-
-
-    borg_grid *ag= &borg_grids[c_y][c_x];
-
-    /* Extract panel */
-    q_x = w_x / PANEL_WID;
-    q_y = w_y / PANEL_HGT;
+    int n;
 
 	/* must have the ability */
 	if (!borg_skill[BI_ATELEPORT]) return (FALSE);
 
-    /* Simulate 100 attempts */
-    for (n = k = 0; k < 100; k++)
-    {
-        /* Pick a location */
-        for (i = 0; i < 100; i++)
-        {
-            /* Pick a (possibly illegal) location */
-            while (1)
-            {
-                y = rand_spread(c_y, dis);
-                x = rand_spread(c_x, dis);
-                d = distance(c_y, c_x, y, x);
-                if ((d >= min) && (d <= dis)) break;
-            }
-
-            /* Ignore illegal locations */
-            if ((y <= 0) || (y >= AUTO_MAX_Y - 1)) continue;
-            if ((x <= 0) || (x >= AUTO_MAX_X - 1)) continue;
-
-            /* Access */
-            ag = &borg_grids[y][x];
-
-			/* Skip unknown grids if explored, or been on level for a while, otherwise, consider ok*/
-            if (ag->feat == FEAT_NONE &&
-                ((borg_detect_wall[q_y+0][q_x+0] == TRUE &&
-        		  borg_detect_wall[q_y+0][q_x+1] == TRUE &&
-        		  borg_detect_wall[q_y+1][q_x+0] == TRUE &&
-        		  borg_detect_wall[q_y+1][q_x+1] == TRUE) ||
-        		 borg_t > 2000)) continue;
-
-            /* Skip weird grids */
-            if (ag->feat == FEAT_INVIS) continue;
-
-            /* Skip walls */
-            if (!borg_cave_floor_bold(y, x)) continue;
-
-            /* Skip monsters */
-            if (ag->kill) continue;
-
-            /* Stop looking */
-            break;
-        }
-
-        /* If low level, unknown squares are scary */
-        if (ag->feat == FEAT_NONE && borg_skill[BI_MAXHP] < 30)
-        {
-            n++;
-            continue;
-        }
-
-        /* No location */
-        /* in the real code it would keep trying but here we should */
-        /* assume that there is unknown spots that you would be able */
-        /* to go but may be dangerious. */
-        if (i >= 100)
-        {
-            n++;
-            continue;
-        }
-
-        /* Examine */
-        p = borg_danger(y, x, turns, TRUE, FALSE);
-
-        /* if *very* scary, do not allow jumps at all */
-        if (p > borg_skill[BI_CURHP]) n++;
-    }
+    /* Expected scary landings out of 100 */
+    n = borg_landing_scary(borg_landing_table(BORG_LAND_TELEPORT, turns),
+                           borg_skill[BI_CURHP], FALSE);
 
     /* Too much danger */
     /* in an emergency try with extra danger allowed */
@@ -4024,15 +4212,12 @@ bool borg_caution(void)
 					 * Skip this grid if it is adjacent to a monster.  He will just hit me
 					 * when I land on that grid.
 					 */
-					for (ii = 1; ii < borg_kills_nxt; ii++)
+					for (ii = 0; ii < borg_kills_live_n; ii++)
 					{
 						borg_kill *kill;
 
 						/* Monster */
-						kill = &borg_kills[ii];
-
-						/* Skip dead monsters */
-						if (!kill->r_idx) continue;
+						kill = &borg_kills[borg_kills_live[ii]];
 
 						/* Require current knowledge */
 						if (kill->when < borg_t - 2) continue;
@@ -4171,15 +4356,12 @@ bool borg_caution(void)
 			 * Skip this grid if it is adjacent to a monster.  He will just hit me
 			 * when I land on that grid.
 			 */
-		    for (ii = 1; ii < borg_kills_nxt; ii++)
+		    for (ii = 0; ii < borg_kills_live_n; ii++)
 			{
 				borg_kill *kill;
 
 				/* Monster */
-				kill = &borg_kills[ii];
-
-				/* Skip dead monsters */
-				if (!kill->r_idx) continue;
+				kill = &borg_kills[borg_kills_live[ii]];
 
 				/* Require current knowledge */
 				if (kill->when < borg_t - 2) continue;
@@ -5040,7 +5222,7 @@ bool borg_target_unknown_wall(int y, int x)
 		if (rf_has(r_ptr->flags, RF_PASS_WALL))
 		{
 			borg_note(format("# Guessing wall (%d,%d) under ghostly target (%d,%d)", n_y, n_x, n_y, n_x));
-			borg_grids[n_y][n_x].feat = FEAT_WALL_EXTRA;
+			borg_set_feat(&borg_grids[n_y][n_x], FEAT_WALL_EXTRA);
 			found = TRUE;
 			return (found); /* not sure... should we return here? */
 		}
@@ -5050,7 +5232,7 @@ bool borg_target_unknown_wall(int y, int x)
             ((n_x != c_x) || !x_hall))
         {
             borg_note(format("# Guessing wall (%d,%d) near target (%d,%d)", n_y, n_x, y, x));
-            borg_grids[n_y][n_x].feat = FEAT_WALL_EXTRA;
+            borg_set_feat(&borg_grids[n_y][n_x], FEAT_WALL_EXTRA);
             found = TRUE;
             return (found); /* not sure... should we return here?
                              maybe should mark ALL unknowns in path... */
@@ -6035,16 +6217,102 @@ static int borg_launch_bolt_aux_hack(int i, int dam, int typ, int ammo_location)
 
 
 /*
- * Determine the "reward" of launching a beam/bolt/ball at a location
+ * Launch geometry.
  *
- * An "unreachable" location always has zero reward.
+ * What a bolt, beam or ball aimed at a grid runs into does not depend on
+ * its damage or its element, so during one borg_attack() each (grid,
+ * radius, range) is traced once and every attack type is scored against
+ * the same trace.  A trace holds the monsters met along the path, how
+ * the path ended, and the monsters and objects caught in the blast.
+ * Traces are stamped with the serial of the borg_attack() call, so
+ * nothing outlives it; outside of borg_attack() every launch is traced
+ * afresh.
  *
- * Basically, we sum the "rewards" of doing the appropriate amount of
- * damage to each of the "affected" monsters.
+ * Define BORG_LAUNCH_UNSHARED to trace every launch afresh, as before
+ * the traces were shared.  With BORG_PROFILE, replaying one journal
+ * (see the 'j' command) with and without it gives the "attack" time
+ * before and after.
+ */
+#define BORG_LAUNCH_ZERO    0   /* Blocked, no reward */
+#define BORG_LAUNCH_PATH    1   /* Reward from the path only */
+#define BORG_LAUNCH_BLAST   2   /* Reward from the blast */
+
+#define BORG_LAUNCH_SLOTS   1024
+#define BORG_LAUNCH_POOL    (4 * AUTO_TEMP_MAX)
+
+typedef struct borg_launch_geom borg_launch_geom;
+
+struct borg_launch_geom
+{
+    u32b serial;        /* borg_attack() call, zero if unused */
+    s16b y, x;          /* Target grid */
+    s16b rad, max;      /* Radius and range */
+
+    byte stop;          /* How the path ended */
+    s16b path_n;        /* Monsters met along the path */
+    s16b blast_n;       /* Grids caught in the blast */
+    s32b pool;          /* Start of both lists in borg_launch_pool */
+};
+
+static borg_launch_geom *borg_launch_geoms;
+static borg_launch_geom borg_launch_scratch;
+
+/* Path monsters, then (monster, damage divisor - 1, object) per blast grid */
+static s16b *borg_launch_pool;
+static s32b borg_launch_top = 0;
+
+/* Serial of the current borg_attack() call, zero outside of one */
+static u32b borg_launch_serial = 0;
+static u32b borg_launch_last = 0;
+
+s32b borg_launch_shared = 0;
+s32b borg_launch_traced = 0;
+
+
+/*
+ * Start (or stop) sharing launch geometry
+ */
+static void borg_launch_share(bool share)
+{
+#ifdef BORG_LAUNCH_UNSHARED
+    /* Never share */
+    share = FALSE;
+#endif /* BORG_LAUNCH_UNSHARED */
+
+    /* Stop */
+    if (!share)
+    {
+        borg_launch_serial = 0;
+        return;
+    }
+
+    /* Zero marks unused slots */
+    if (!++borg_launch_last) borg_launch_last++;
+
+    /* Start afresh */
+    borg_launch_serial = borg_launch_last;
+    borg_launch_top = 0;
+}
+
+
+/*
+ * How a path ends when it is stopped short.  Beams and dispels keep
+ * what they met on the way, everything else is wasted.
+ */
+static byte borg_launch_stop(int rad)
+{
+    if (rad != -1 && rad != 10) return (BORG_LAUNCH_ZERO);
+    return (BORG_LAUNCH_PATH);
+}
+
+
+/*
+ * Trace a beam/bolt/ball launched at a location into "g"
  *
- * We will attempt to apply the offset-ball attack here
+ * This follows the spell/missile path exactly as the game would, and
+ * records what it meets rather than scoring it.
  */
-static int borg_launch_bolt_aux(int y, int x, int rad, int dam, int typ, int max, int ammo_location)
+static void borg_launch_trace(borg_launch_geom *g, int y, int x, int rad, int max)
 {
     int i;
 
@@ -6053,7 +6321,9 @@ static int borg_launch_bolt_aux(int y, int x, int rad, int dam, int typ, int max
 
     int dist;
 
-    int r, n;
+    int r;
+
+    s16b *list = borg_launch_pool + g->pool;
 
     borg_grid *ag;
     monster_race *r_ptr;
@@ -6068,8 +6338,9 @@ static int borg_launch_bolt_aux(int y, int x, int rad, int dam, int typ, int max
     q_x = w_x / 33;
     q_y = w_y / 11;
 
-    /* Reset damage */
-    n = 0;
+    /* Nothing met yet */
+    g->path_n = 0;
+    g->blast_n = 0;
 
     /* Initial location */
     x1 = c_x; y1 = c_y;
@@ -6107,23 +6378,25 @@ static int borg_launch_bolt_aux(int y, int x, int rad, int dam, int typ, int max
             /* dispel spells act like beams (sort of) */
             if (!borg_cave_floor_grid(ag))
             {
-				if (rad != -1 && rad != 10)
-                    return (0);
-                else
-                    return (n);
+				g->stop = borg_launch_stop(rad);
+				return;
             }
         }
 
 
-        /* Collect damage (bolts/beams) */
-        if (rad <= 0 || rad == 10) n += borg_launch_bolt_aux_hack(ag->kill, dam, typ, ammo_location);
+        /* Collect monsters (bolts/beams) */
+        if ((rad <= 0 || rad == 10) && ag->kill) list[g->path_n++] = ag->kill;
 
         /* Check for arrival at "final target" */
         /* except beams, which keep going. */
         if ( (rad != -1 && rad !=10)  && ((x == x2) && (y == y2))) break;
 
         /* Stop bolts at monsters  */
-        if (!rad && ag->kill) return (n);
+        if (!rad && ag->kill)
+        {
+            g->stop = BORG_LAUNCH_PATH;
+            return;
+        }
 
         /* The missile path can be complicated.  There are several checks
          * which need to be made.  First we assume that we targetting
@@ -6170,10 +6443,8 @@ static int borg_launch_bolt_aux(int y, int x, int rad, int dam, int typ, int max
                 /* note if beam, dispel, this is the end of the beam */
                 if (ag->feat == FEAT_NONE && borg_skill[BI_CLEVEL] < 5)
                     {
-                        if (rad != -1 && rad !=10)
-                            return (0);
-                        else
-                            return (n);
+                        g->stop = borg_launch_stop(rad);
+                        return;
                     }
 
                 /* Stop at weird grids (see above).
@@ -6188,10 +6459,8 @@ static int borg_launch_bolt_aux(int y, int x, int rad, int dam, int typ, int max
 					(borg_skill[BI_CLEVEL] < 5 ||
 					 rf_has(r_ptr_path->flags, RF_PASS_WALL))) /* should be THIS grid's monster is passwall */
                 {
-                    if (rad != -1 && rad !=10)
-                        return (0);
-                    else
-                        return (n);
+                    g->stop = borg_launch_stop(rad);
+                    return;
                 }
 
                 /* Stop at unseen walls */
@@ -6202,10 +6471,8 @@ static int borg_launch_bolt_aux(int y, int x, int rad, int dam, int typ, int max
                     /* Skip only one round in this case */
                     if (successful_target <= -12)
                         successful_target = 0;
-                    if (rad != -1 && rad !=10)
-                        return (0);
-                    else
-                        return (n);
+                    g->stop = borg_launch_stop(rad);
+                    return;
                 }
             }
             else  /* I do have infravision or it's a lite monster */
@@ -6218,10 +6485,8 @@ static int borg_launch_bolt_aux(int y, int x, int rad, int dam, int typ, int max
                     /* Skip only one round in this case */
                     if (successful_target <= -12)
                         successful_target = 0;
-                    if (rad != -1 && rad !=10)
-                        return (0);
-                    else
-                        return (n);
+                    g->stop = borg_launch_stop(rad);
+                    return;
                 }
             }
          }
@@ -6244,10 +6509,8 @@ static int borg_launch_bolt_aux(int y, int x, int rad, int dam, int typ, int max
                     /* note if beam, dispel, this is the end of the beam */
                 if (ag->feat == FEAT_NONE && borg_skill[BI_CLEVEL] < 5)
                     {
-                        if (rad != -1 && rad !=10)
-                            return (0);
-                        else
-                            return (n);
+                        g->stop = borg_launch_stop(rad);
+                        return;
                     }
                     /* Stop at unseen walls */
                     /* We just shot and missed, this is our next shot */
@@ -6257,10 +6520,8 @@ static int borg_launch_bolt_aux(int y, int x, int rad, int dam, int typ, int max
                         /* Skip only one round in this case */
                         if (successful_target <= -12)
                             successful_target = 0;
-                        if (rad != -1 && rad !=10)
-                            return (0);
-                        else
-                            return (n);
+                        g->stop = borg_launch_stop(rad);
+                        return;
                     }
                 }
 
@@ -6270,10 +6531,8 @@ static int borg_launch_bolt_aux(int y, int x, int rad, int dam, int typ, int max
 					(borg_skill[BI_CLEVEL] < 5 ||
 					(rf_has(r_ptr->flags, RF_PASS_WALL)))) /* should be THIS grid's monster is passwall */
                 {
-					if (rad != -1 && rad !=10)
-                        return (0);
-                    else
-                        return (n);
+					g->stop = borg_launch_stop(rad);
+					return;
                 }
                 /* Stop at unseen walls */
                 /* We just shot and missed, this is our next shot */
@@ -6284,10 +6543,8 @@ static int borg_launch_bolt_aux(int y, int x, int rad, int dam, int typ, int max
                     if (successful_target <= -12)
                         successful_target = 0;
 
-                     if (rad != -1 && rad !=10)
-                         return (0);
-                     else
-                         return (n);
+                     g->stop = borg_launch_stop(rad);
+                     return;
                 }
             }
         }
@@ -6297,10 +6554,22 @@ static int borg_launch_bolt_aux(int y, int x, int rad, int dam, int typ, int max
     }
 
     /* Bolt/Beam attack */
-    if (rad <= 0 ) return (n);
+    if (rad <= 0)
+    {
+        g->stop = BORG_LAUNCH_PATH;
+        return;
+    }
 
     /* Excessive distance */
-    if (dist >= max) return (0);
+    if (dist >= max)
+    {
+        g->stop = BORG_LAUNCH_ZERO;
+        return;
+    }
+
+    /* Ball attack */
+    g->stop = BORG_LAUNCH_BLAST;
+    list += g->path_n;
 
     /* Check monsters in blast radius */
     for (i = 0; i < borg_temp_n; i++)
@@ -6324,15 +6593,122 @@ static int borg_launch_bolt_aux(int y, int x, int rad, int dam, int typ, int max
         /*  dispel spells should hurt the same no matter the rad: make r= y  and x */
         if (rad == 10) r = 0;
 
+        /* Save the monster, the damage divisor and any object */
+        *list++ = ag->kill;
+        *list++ = r;
+        *list++ = ag->take;
+        g->blast_n++;
+    }
+}
+
+
+/*
+ * Find (or make) the trace of a launch at a location
+ */
+static borg_launch_geom *borg_launch_find(int y, int x, int rad, int max)
+{
+    borg_launch_geom *g;
+
+    u32b h;
+
+    /* Room for the longest path and every monster in the blast */
+    if (borg_launch_top + max + 3 * borg_temp_n > BORG_LAUNCH_POOL)
+    {
+        /* Start over */
+        if (borg_launch_serial) borg_launch_share(TRUE);
+        borg_launch_top = 0;
+    }
+
+    /* A missed shot changes the trace (see above), never share it */
+    if (!borg_launch_serial || successful_target < 0)
+    {
+        g = &borg_launch_scratch;
+        g->pool = borg_launch_top;
+        borg_launch_trace(g, y, x, rad, max);
+        borg_launch_traced++;
+        return (g);
+    }
+
+    /* Hash the key */
+    h = (u32b)((y * AUTO_MAX_X + x) * 16 + rad + 1) * 64 + max;
+    h = (h ^ (h >> 13)) * 0x5bd1e995;
+    h ^= h >> 15;
+
+    g = &borg_launch_geoms[h & (BORG_LAUNCH_SLOTS - 1)];
+
+    /* Traced already */
+    if (g->serial == borg_launch_serial && g->y == y && g->x == x &&
+        g->rad == rad && g->max == max)
+    {
+        borg_launch_shared++;
+        return (g);
+    }
+
+    /* Trace it */
+    g->serial = borg_launch_serial;
+    g->y = y;
+    g->x = x;
+    g->rad = rad;
+    g->max = max;
+    g->pool = borg_launch_top;
+    borg_launch_trace(g, y, x, rad, max);
+    borg_launch_traced++;
+
+    /* Keep the lists */
+    borg_launch_top += g->path_n + 3 * g->blast_n;
+
+    return (g);
+}
+
+
+/*
+ * Determine the "reward" of launching a beam/bolt/ball at a location
+ *
+ * An "unreachable" location always has zero reward.
+ *
+ * Basically, we sum the "rewards" of doing the appropriate amount of
+ * damage to each of the "affected" monsters.
+ *
+ * We will attempt to apply the offset-ball attack here
+ */
+static int borg_launch_bolt_aux(int y, int x, int rad, int dam, int typ, int max, int ammo_location)
+{
+    int i, n;
+
+    borg_launch_geom *g;
+    s16b *list;
+
+    /* Find the trace */
+    g = borg_launch_find(y, x, rad, max);
+    list = borg_launch_pool + g->pool;
+
+    /* Unreachable */
+    if (g->stop == BORG_LAUNCH_ZERO) return (0);
+
+    /* Reset damage */
+    n = 0;
+
+    /* Collect damage (bolts/beams) */
+    for (i = 0; i < g->path_n; i++)
+    {
+        n += borg_launch_bolt_aux_hack(list[i], dam, typ, ammo_location);
+    }
+
+    /* Bolt/Beam attack */
+    if (g->stop == BORG_LAUNCH_PATH) return (n);
+
+    /* Check monsters in blast radius */
+    for (list += g->path_n, i = 0; i < g->blast_n; i++, list += 3)
+    {
         /* Collect damage, lowered by distance */
-        n += borg_launch_bolt_aux_hack(ag->kill, dam / (r + 1), typ, ammo_location);
+        n += borg_launch_bolt_aux_hack(list[0], dam / (list[1] + 1), typ, ammo_location);
 
         /* probable damage int was just changed by b_l_b_a_h*/
 
         /* check destroyed stuff. */
-        if (ag->take)
+        if (list[2])
         {
-            borg_take *take = &borg_takes[ag->take];
+            borg_take *take = &borg_takes[list[2]];
             object_kind *k_ptr = &k_info[take->k_idx];
 
             switch (typ)
@@ -9699,6 +10075,9 @@ bool borg_attack(bool boosted_bravery)
     int g, b_g = -1;
 	bool adjacent_monster = FALSE;
 
+    int num;
+    byte list[256];
+
     borg_grid *ag;
     monster_race *r_ptr;
 
@@ -9713,17 +10092,15 @@ bool borg_attack(bool boosted_bravery)
     borg_temp_n = 0;
 
     /* Find "nearby" monsters */
-    for (i = 1; i < borg_kills_nxt; i++)
+    num = borg_cell_query(&borg_kill_cells, c_y, c_x, MAX_RANGE, list);
+    for (i = 0; i < num; i++)
     {
         borg_kill *kill;
 
         /* Monster */
-        kill = &borg_kills[i];
+        kill = &borg_kills[list[i]];
         r_ptr = &r_info[kill->r_idx];
 
-        /* Skip dead monsters */
-        if (!kill->r_idx) continue;
-
         /* Require current knowledge */
         if (kill->when < borg_t - 2) continue;
 
@@ -9822,6 +10199,8 @@ bool borg_attack(bool boosted_bravery)
         return (FALSE);
     }
 
+    /* Share launch geometry between the attacks */
+    borg_launch_share(TRUE);
 
 	/* Simulate */
     borg_simulate = TRUE;
@@ -9844,6 +10223,7 @@ bool borg_attack(bool boosted_bravery)
     /* Nothing good */
     if (b_n <= 0)
     {
+        borg_launch_share(FALSE);
         borg_attacking = FALSE;
         return (FALSE);
     }
@@ -9858,6 +10238,7 @@ bool borg_attack(bool boosted_bravery)
     /* Instantiate */
     (void)borg_attack_aux(b_g);
 
+    borg_launch_share(FALSE);
     borg_attacking = FALSE;
 
     /* Success */
@@ -9911,17 +10292,14 @@ bool borg_munchkin_mage(void)
     borg_temp_n = 0;
 
     /* Find "nearby" monsters */
-    for (i = 1; i < borg_kills_nxt; i++)
+    for (i = 0; i < borg_kills_live_n; i++)
     {
         borg_kill *kill;
 
         /* Monster */
-        kill = &borg_kills[i];
+        kill = &borg_kills[borg_kills_live[i]];
         r_ptr = &r_info[kill->r_idx];
 
-        /* Skip dead monsters */
-        if (!kill->r_idx) continue;
-
         /* Require current knowledge */
         if (kill->when < borg_t - 2) continue;
 
@@ -10048,17 +10426,14 @@ bool borg_munchkin_melee(void)
     borg_temp_n = 0;
 
     /* Find "nearby" monsters */
-    for (i = 1; i < borg_kills_nxt; i++)
+    for (i = 0; i < borg_kills_live_n; i++)
     {
         borg_kill *kill;
 
         /* Monster */
-        kill = &borg_kills[i];
+        kill = &borg_kills[borg_kills_live[i]];
         r_ptr = &r_info[kill->r_idx];
 
-        /* Skip dead monsters */
-        if (!kill->r_idx) continue;
-
         /* Require current knowledge */
         if (kill->when < borg_t - 2) continue;
 
@@ -14229,18 +14604,20 @@ bool borg_check_rest(int y, int x)
 	}
 
     /* Examine all the monsters */
-    for (i = 1; i < borg_kills_nxt; i++)
+    for (ii = 0; ii < borg_kills_live_n; ii++)
     {
-        borg_kill *kill = &borg_kills[i];
-        monster_race *r_ptr = &r_info[kill->r_idx];
+        borg_kill *kill;
+        monster_race *r_ptr;
 
-        int x9 = kill->x;
-        int y9 = kill->y;
+        int x9, y9;
         int ax, ay, d;
         int p = 0;
 
-        /* Skip dead monsters */
-        if (!kill->r_idx) continue;
+        i = borg_kills_live[ii];
+        kill = &borg_kills[i];
+        r_ptr = &r_info[kill->r_idx];
+        x9 = kill->x;
+        y9 = kill->y;
 
         /* Distance components */
         ax = (x9 > x) ? (x9 - x) : (x - x9);
@@ -15121,7 +15498,7 @@ static bool borg_play_step(int y2, int x2)
         borg_keypress(I2D(dir));
 
         /* We are not sure if the trap will get 'untrapped'. pretend it will*/
-        ag->feat = FEAT_NONE;
+        borg_set_feat(ag, FEAT_NONE);
         return (TRUE);
     }
 
@@ -16326,7 +16703,7 @@ bool borg_excavate_vault(int range)
 			/* Dark */
 			borg_grids[borg_temp_y[i]][borg_temp_x[i]].info |= BORG_GLOW;
 			/* Feat Floor */
-			borg_grids[borg_temp_y[i]][borg_temp_x[i]].feat = FEAT_FLOOR;
+			borg_set_feat(&borg_grids[borg_temp_y[i]][borg_temp_x[i]], FEAT_FLOOR);
 
 
 
@@ -17075,9 +17452,6 @@ bool borg_flow_kill(bool viewable, int nearness)
         /* skip certain ones */
         if (skip_monster) continue;
 
-		/* Clear the flow codes */
-		borg_flow_clear();
-
 		/* Check the distance to stair for this proposed grid and leash*/
 		if (borg_flow_cost_stair(y,x, b_stair) > borg_skill[BI_CLEVEL] * 3 +9 && borg_skill[BI_CLEVEL] < 20) continue;
 
@@ -17184,9 +17558,6 @@ bool borg_flow_vein(bool viewable, int nearness)
         /* Require line of sight if requested */
         if (viewable && !(ag->info & BORG_VIEW)) continue;
 
-		/* Clear the flow codes */
-		borg_flow_clear();
-
 		/* obtain the number of steps from this take to the stairs */
 		cost = borg_flow_cost_stair(y,x, b_stair);
 
@@ -17339,9 +17710,6 @@ bool borg_flow_take(bool viewable, int nearness)
         /* Require line of sight if requested */
         if (viewable && !(ag->info & BORG_VIEW)) continue;
 
-		/* Clear the flow codes */
-		borg_flow_clear();
-
 		/* Check the distance to stair for this proposed grid and leash*/
 		if (nearness > 5 && borg_flow_cost_stair(y,x, b_stair) > leash && borg_skill[BI_CLEVEL] < 20) continue;
 
@@ -17449,9 +17817,6 @@ bool borg_flow_take_scum(bool viewable, int nearness)
         /* Require line of sight if requested */
         if (viewable && !(ag->info & BORG_VIEW)) continue;
 
-		/* Clear the flow codes */
-		borg_flow_clear();
-
 		/* Check the distance to stair for this proposed grid with leash */
 		if (borg_flow_cost_stair(y,x, b_stair) > borg_skill[BI_CLEVEL] * 3 +9 && borg_skill[BI_CLEVEL] < 20) continue;
 
@@ -17634,9 +17999,6 @@ bool borg_flow_take_lunal(bool viewable, int nearness)
         /* Require line of sight if requested */
         if (viewable && !(ag->info & BORG_VIEW)) continue;
 
-		/* Clear the flow codes */
-		borg_flow_clear();
-
 		/* Check the distance to stair for this proposed grid */
 		if (borg_flow_cost_stair(y,x, b_stair) > borg_skill[BI_CLEVEL] * 3 +9 && borg_skill[BI_CLEVEL] < 20) continue;
 
@@ -18026,6 +18388,9 @@ static void borg_flow_direct(int y, int x)
     borg_grid *ag;
 
 
+    /* The cost field no longer matches the goal set */
+    flow_cacheable = FALSE;
+
     /* Avoid icky grids */
     if (borg_data_icky->data[y][x]) return;
 
@@ -18325,6 +18690,9 @@ static void borg_flow_border(int y1, int x1, int y2, int x2, bool stop)
 {
     int x, y;
 
+    /* Cached flows used the old flags */
+    borg_flow_epoch++;
+
     /* Scan west/east edges */
     for (y = y1; y <= y2; y++)
     {
@@ -18379,9 +18747,6 @@ static bool borg_flow_dark_1(int b_stair)
         /* Skip "boring" grids (assume reachable) */
         if (!borg_flow_dark_interesting(y, x, b_stair)) continue;
 
-		/* Clear the flow codes */
-		borg_flow_clear();
-
 		/* obtain the number of steps from this take to the stairs */
 		cost = borg_flow_cost_stair(y,x, b_stair);
 
@@ -18483,9 +18848,6 @@ static bool borg_flow_dark_2(int b_stair)
 
         /* if it makes me wander, skip it */
 
-		/* Clear the flow codes */
-		borg_flow_clear();
-
 		/* obtain the number of steps from this take to the stairs */
 		cost = borg_flow_cost_stair(y,x, b_stair);
 
@@ -18582,9 +18944,6 @@ static bool borg_flow_dark_3(int b_stair)
             /* Skip "unreachable" grids */
             if (!borg_flow_dark_reachable(y, x)) continue;
 
-			/* Clear the flow codes */
-			borg_flow_clear();
-
 			/* obtain the number of steps from this take to the stairs */
 			cost = borg_flow_cost_stair(y,x, b_stair);
 
@@ -18692,9 +19051,6 @@ static bool borg_flow_dark_4(int b_stair)
             /* Skip "unreachable" grids */
             if (!borg_flow_dark_reachable(y, x)) continue;
 
-			/* Clear the flow codes */
-			borg_flow_clear();
-
 			/* obtain the number of steps from this take to the stairs */
 			cost = borg_flow_cost_stair(y,x, b_stair);
 
@@ -18791,9 +19147,6 @@ static bool borg_flow_dark_5(int b_stair)
             /* Skip "unreachable" grids */
             if (!borg_flow_dark_reachable(y, x)) continue;
 
-			/* Clear the flow codes */
-			borg_flow_clear();
-
 			/* obtain the number of steps from this take to the stairs */
 			cost = borg_flow_cost_stair(y,x, b_stair);
 
@@ -19240,7 +19593,23 @@ bool borg_flow_spastic(bool bored)
  */
 void borg_init_6(void)
 {
-    /* Nothing */
+    int i;
+
+    /* Make the flow cache */
+    for (i = 0; i < BORG_FLOW_CACHE_MAX; i++)
+    {
+        MAKE(flow_cache_data[i], borg_data);
+    }
+
+    /* Make the stair field */
+    MAKE(borg_data_stair, borg_data);
+
+    /* Make the landing tables */
+    C_MAKE(borg_landings, BORG_LAND_MAX, borg_landing);
+
+    /* Make the launch traces */
+    C_MAKE(borg_launch_geoms, BORG_LAUNCH_SLOTS, borg_launch_geom);
+    C_MAKE(borg_launch_pool, BORG_LAUNCH_POOL, s16b);
 }
 
 
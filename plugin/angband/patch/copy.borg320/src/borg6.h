@@ -116,6 +116,11 @@ extern bool borg_LIGHT_beam(bool simulation);
  */
 extern bool borg_flow_dark(bool neer);
 
+/*
+ * Distance from a grid to one of the known up stairs
+ */
+extern int borg_flow_cost_stair(int y, int x, int b_stair);
+
 /*
  * Search for secret doors
  */
@@ -123,6 +128,12 @@ extern bool borg_flow_spastic(bool bored);
 
 extern bool borg_target(int y, int x);
 extern int borg_launch_damage_one(int i, int dam, int typ, int ammo_location);
+
+/*
+ * Launch traces shared within a borg_attack(), and traces worked out
+ */
+extern s32b borg_launch_shared;
+extern s32b borg_launch_traced;
 extern int borg_attack_aux_thrust(void);
 
 
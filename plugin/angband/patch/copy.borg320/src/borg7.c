@@ -4203,6 +4203,111 @@ static byte borg_best_stuff_order[] =
 };
 
 
+/*
+ * Candidates for each slot, gathered once by "borg_best_stuff_scan()".
+ * Pack items are stored by index, home items by index plus 100, which
+ * is also how "borg_best_stuff()" reads the results.
+ */
+static byte borg_best_stuff_cand[12][INVEN_MAX_PACK + STORE_INVEN_MAX];
+static int borg_best_stuff_cand_num[12];
+
+
+/*
+ * Access a candidate item
+ */
+static borg_item *borg_best_stuff_item(int i)
+{
+    if (i < 100) return (&borg_items[i]);
+    return (&borg_shops[7].ware[i - 100]);
+}
+
+
+/*
+ * Gather the items that may go in each slot.
+ *
+ * Everything here depends only on the item and on what is worn in the
+ * slot now, so it is checked once instead of at every level of the
+ * search.  Items identical to the worn item, or to an earlier candidate,
+ * give the same power and are left out.
+ */
+static void borg_best_stuff_scan(void)
+{
+    int n, i, k;
+
+    int slot;
+
+    /* Scan the slots */
+    for (n = 0; (slot = borg_best_stuff_order[n]) != 255; n++)
+    {
+        borg_best_stuff_cand_num[n] = 0;
+
+        /* Make sure that slot does not have a cursed item */
+        if (borg_items[slot].cursed) continue;
+
+        /* Try other possible objects */
+        for (i = 0; i < ((shop_num == 7) ? (INVEN_MAX_PACK + STORE_INVEN_MAX) : INVEN_MAX_PACK); i++)
+        {
+            borg_item *item;
+            byte code;
+
+            if (i < INVEN_MAX_PACK)
+                code = i;
+            else
+                /* if in home, note by adding 100 to item number. */
+                code = (i - INVEN_MAX_PACK) + 100;
+
+            item = borg_best_stuff_item(code);
+
+            /* Skip empty items */
+            if (!item->iqty) continue;
+
+            /* Require "aware" */
+            if (!item->kind) continue;
+
+            /* Require "known" (or average, good, etc) */
+            if (!item->ident &&
+                !strstr(item->note, "average") &&
+                !strstr(item->note, "magical") &&
+                !strstr(item->note, "ego") &&
+                !strstr(item->note, "splendid") &&
+                !strstr(item->note, "excellent") &&
+                !strstr(item->note, "indestructible") &&
+                !strstr(item->note, "special")) continue;
+
+            /* Hack -- ignore "worthless" items */
+            if (!item->value) continue;
+
+            /* Skip it if it has not been decursed */
+            if (item->cursed ||
+                of_has(item->flags, OF_LIGHT_CURSE)||
+                of_has(item->flags, OF_HEAVY_CURSE)||
+                of_has(item->flags, OF_PERMA_CURSE)) continue;
+
+            /* Do not wear not *idd* artifacts */
+            if ((op_ptr->opt[OPT_birth_randarts] || op_ptr->opt[OPT_adult_randarts]) &&
+                !item->fully_identified && item->name1) continue;
+
+            /* Make sure it goes in this slot, special consideration for checking rings */
+            if (slot != borg_wield_slot(item)) continue;
+
+            /* Same as the default item */
+            if (!memcmp(item, &borg_items[slot], sizeof(borg_item))) continue;
+
+            /* Same as an earlier candidate */
+            for (k = 0; k < borg_best_stuff_cand_num[n]; k++)
+            {
+                if (!memcmp(item, borg_best_stuff_item(borg_best_stuff_cand[n][k]),
+                            sizeof(borg_item))) break;
+            }
+            if (k < borg_best_stuff_cand_num[n]) continue;
+
+            /* Accept */
+            borg_best_stuff_cand[n][borg_best_stuff_cand_num[n]++] = code;
+        }
+    }
+}
+
+
 /*
  * Helper function (see below)
  */
@@ -4260,63 +4365,14 @@ static void borg_best_stuff_aux(int n, byte *test, byte *best, s32b *vp)
     borg_best_stuff_aux(n + 1, test, best, vp);
 
 
-    /* Try other possible objects */
-    for (i = 0; i < ((shop_num == 7) ? (INVEN_MAX_PACK + STORE_INVEN_MAX) : INVEN_MAX_PACK); i++)
+    /* Try the other possible objects */
+    for (i = 0; i < borg_best_stuff_cand_num[n]; i++)
     {
-        borg_item *item;
-        if (i < INVEN_MAX_PACK)
-            item = &borg_items[i];
-        else
-            item = &borg_shops[7].ware[i - INVEN_MAX_PACK];
-
-        /* Skip empty items */
-        if (!item->iqty) continue;
-
-        /* Require "aware" */
-        if (!item->kind) continue;
-
-        /* Require "known" (or average, good, etc) */
-        if (!item->ident &&
-            !strstr(item->note, "average") &&
-            !strstr(item->note, "magical") &&
-            !strstr(item->note, "ego") &&
-            !strstr(item->note, "splendid") &&
-            !strstr(item->note, "excellent") &&
-            !strstr(item->note, "indestructible") &&
-            !strstr(item->note, "special")) continue;
-
-        /* Hack -- ignore "worthless" items */
-        if (!item->value) continue;
-
-        /* Skip it if it has not been decursed */
-        if (item->cursed ||
-            of_has(item->flags, OF_LIGHT_CURSE)||
-            of_has(item->flags, OF_HEAVY_CURSE)||
-            of_has(item->flags, OF_PERMA_CURSE)) continue;
-
-        /* Do not wear not *idd* artifacts */
-        if ((op_ptr->opt[OPT_birth_randarts] || op_ptr->opt[OPT_adult_randarts]) &&
-            !item->fully_identified && item->name1) continue;
-
-        /* Make sure it goes in this slot, special consideration for checking rings */
-        if (slot != borg_wield_slot(item)) continue;
-
-        /* Make sure that slot does not have a cursed item */
-        if (borg_items[slot].cursed ||
-            of_has(item->flags, OF_LIGHT_CURSE)||
-            of_has(item->flags, OF_HEAVY_CURSE)||
-            of_has(item->flags, OF_PERMA_CURSE)) continue;
-
-        /* Wear the new item */
-        COPY(&borg_items[slot], item, borg_item);
-
         /* Note the attempt */
-        if (i < INVEN_MAX_PACK)
-            test[n] = i;
-        else
-            /* if in home, note by adding 100 to item number. */
-            test[n] = (i - INVEN_MAX_PACK) + 100;
+        test[n] = borg_best_stuff_cand[n][i];
 
+        /* Wear the new item */
+        COPY(&borg_items[slot], borg_best_stuff_item(test[n]), borg_item);
 
         /* Evaluate the possible item */
         borg_best_stuff_aux(n + 1, test, best, vp);
@@ -4380,6 +4436,9 @@ bool borg_best_stuff(void)
     /* Evaluate the inventory */
     value = my_power;
 
+    /* Gather the candidates for each slot */
+    borg_best_stuff_scan();
+
     /* Determine the best possible equipment */
     (void)borg_best_stuff_aux(0, test, best, &value);
 
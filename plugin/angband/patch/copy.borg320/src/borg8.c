@@ -13,6 +13,8 @@
 #include "borg7.h"
 #include "borg8.h"
 
+#include <time.h>
+
 #ifdef BABLOS
 extern bool borg_clock_over;
 #endif /* bablos */
@@ -23,6 +25,41 @@ byte *best;
 s32b *b_home_power;
 
 
+/*
+ * Slow home optimizer state.
+ *
+ * Pack items which may go to the home are listed once per search, along
+ * with whether they would stack with something already there.  Leaves
+ * are remembered by a hash of the home and the pack quantities, since
+ * different orders of the same moves reach the same home.
+ */
+#define BORG_HOME_MEMO_MAX 4096
+
+/*
+ * While a session is journaled the clock is not repeatable, so the
+ * budget is counted in leaves instead, this many per millisecond.
+ */
+#define BORG_HOME_LEAVES_MSEC 100
+
+typedef struct borg_home_memo borg_home_memo;
+
+struct borg_home_memo
+{
+    u32b hash1;         /* FNV-1a of the home and pack */
+    u32b hash2;         /* djb2 of the home and pack */
+    s32b power;         /* borg_power_home() */
+};
+
+static borg_home_memo *home_memo;
+static byte home_cand[INVEN_MAX_PACK];
+static int home_cand_num;
+static bool home_cand_stacks[INVEN_MAX_PACK];
+static int home_cand_twin[INVEN_MAX_PACK];
+static clock_t home_deadline;
+static s32b home_leaves;
+static bool home_out_of_time;
+
+
 /* money Scumming is a type of town scumming for money */
 void borg_money_scum(void)
 {
@@ -390,22 +427,165 @@ static int borg_min_item_quantity(borg_item *item)
  *   not worth any money, since it may save us money eventually.
  */
 
-/* this optimized the home storage by trying every combination... it was too slow.*/
-/* put this code back when running this on a Cray. */
-static void borg_think_home_sell_aux2_slow(  int n, int start_i )
+/*
+ * Add a block of memory to both home hashes
+ */
+static void borg_home_hash_aux(u32b *h1, u32b *h2, const void *data, size_t size)
+{
+    const byte *p = (const byte *)data;
+    size_t k;
+
+    for (k = 0; k < size; k++)
+    {
+        *h1 = (*h1 ^ p[k]) * 16777619UL;
+        *h2 = (*h2 * 33) + p[k];
+    }
+}
+
+
+/*
+ * Evaluate the current home (remembered)
+ */
+static s32b borg_home_power_memo(void)
 {
     int i;
+    u32b h1 = 2166136261UL, h2 = 5381;
+    borg_home_memo *memo;
+
+    /* Hash the home and what is left in the pack */
+    for (i = 0; i < STORE_INVEN_MAX; i++)
+    {
+        borg_item *item = &borg_shops[7].ware[i];
+
+        borg_home_hash_aux(&h1, &h2, &item->iqty, sizeof(item->iqty));
+        if (item->iqty) borg_home_hash_aux(&h1, &h2, item, sizeof(borg_item));
+    }
+    for (i = 0; i < INVEN_MAX_PACK; i++)
+    {
+        borg_home_hash_aux(&h1, &h2, &borg_items[i].iqty, sizeof(borg_items[i].iqty));
+    }
+
+    memo = &home_memo[h1 % BORG_HOME_MEMO_MAX];
+    if (memo->hash1 == h1 && memo->hash2 == h2) return (memo->power);
+
+    /* Examine the home  */
+    borg_notice_home(NULL, FALSE);
+
+    /* Evaluate the home */
+    memo->hash1 = h1;
+    memo->hash2 = h2;
+    memo->power = borg_power_home();
+
+    return (memo->power);
+}
+
+
+/*
+ * Prepare the slow home optimizer.  This has to be done once the pack
+ * has been reduced to the items that may be given to the home.
+ */
+static void borg_think_home_sell_aux2_prep(void)
+{
+    int i, k;
+
+    /* Forget old leaves */
+    C_WIPE(home_memo, BORG_HOME_MEMO_MAX, borg_home_memo);
+
+    /* Set the clock */
+    home_out_of_time = FALSE;
+    home_deadline = clock() + (clock_t)((double)borg_home_budget * CLOCKS_PER_SEC / 1000);
+    home_leaves = (s32b)borg_home_budget * BORG_HOME_LEAVES_MSEC;
+
+    /* Gather the candidates */
+    home_cand_num = 0;
+    for (i = 0; i < INVEN_MAX_PACK; i++)
+    {
+        borg_item *item = &borg_items[i];
+
+        /* Skip empty items */
+        /* Require "aware" */
+        /* Require "known" */
+        if (!item->iqty || !item->kind || !item->aware)
+            continue;
+
+        /* Hack -- ignore "worthless" items */
+        if (!item->value) continue;
+
+        if (i==weapon_swap && weapon_swap !=0) continue;
+        if (i==armour_swap && armour_swap !=0) continue;
+
+        /* Do not dump stuff at home that is not fully id'd and should be  */
+        /* this is good with random artifacts. */
+        if ((op_ptr->opt[OPT_birth_randarts] || op_ptr->opt[OPT_adult_randarts]) && !item->fully_identified && item->name1) continue;
+
+        /* If this item was just bought a the house, don't tell it back to the house */
+        if (bought_item_tval == item->tval && bought_item_sval == item->sval && bought_item_pval== item->pval && bought_item_store == 7) continue;
+
+        /* Note items that would stack else where in the list. */
+        home_cand_stacks[i] = FALSE;
+        for (k = 0; k < STORE_INVEN_MAX; k++)
+        {
+            if (borg_object_similar(&safe_home[k], item))
+            {
+                home_cand_stacks[i] = TRUE;
+                break;
+            }
+        }
+
+        /* Note an earlier candidate that is the same item */
+        home_cand_twin[home_cand_num] = -1;
+        for (k = 0; k < home_cand_num; k++)
+        {
+            if (borg_object_similar(&borg_items[home_cand[k]], item))
+            {
+                home_cand_twin[home_cand_num] = k;
+                break;
+            }
+        }
+
+        home_cand[home_cand_num++] = i;
+    }
+}
+
+
+/*
+ * This optimizes the home storage by trying every combination, within
+ * the "borg_home_budget".  It starts from the answer of the fast routine
+ * below, so running out of time still leaves a sensible layout.
+ *
+ * It used to be forced off as "broken".  Besides taking far too long, it
+ * lacked the checks the fast routine has for items just bought from the
+ * home and for unidentified randarts, so it could hand back what the
+ * borg had just taken out; both checks are made on the candidates now.
+ *
+ * A candidate is skipped while an earlier one that is the same item is
+ * still in the pack, since giving either leaves the same home and the
+ * earlier one's branch tries everything the later one's would.  Other
+ * candidates cannot be pruned by their worth alone, since what one item
+ * adds to "borg_power_home()" depends on what else is in the home.
+ */
+static void borg_think_home_sell_aux2_slow(  int n, int start_c )
+{
+    int c, i;
+
+    /* Out of time */
+    if (home_out_of_time) return;
 
     /* All done */
     if (n == STORE_INVEN_MAX)
     {
         s32b home_power;
 
-        /* Examine the home  */
-        borg_notice_home(NULL, FALSE);
+        /* Check the clock now and then */
+        if (borg_home_budget > 0 &&
+            (borg_journal ? (--home_leaves < 0) : (clock() > home_deadline)))
+        {
+            borg_note("# Home optimizer ran out of time.");
+            home_out_of_time = TRUE;
+        }
 
         /* Evaluate the home */
-        home_power = borg_power_home();
+        home_power = borg_home_power_memo();
 
         /* Track best */
         if (home_power > *b_home_power)
@@ -442,7 +622,7 @@ static void borg_think_home_sell_aux2_slow(  int n, int start_i )
     test[n] = n;
 
     /* Evaluate the default item */
-    borg_think_home_sell_aux2_slow(n + 1, start_i );
+    borg_think_home_sell_aux2_slow(n + 1, start_c );
 
     /* if this slot and the previous slot is empty, move on to previous slot*/
     /* this will prevent trying a thing in all the empty slots to see if */
@@ -451,50 +631,33 @@ static void borg_think_home_sell_aux2_slow(  int n, int start_i )
         return;
 
     /* try other combinations */
-    for (i = start_i; i < INVEN_MAX_PACK; i++)
+    for (c = start_c; c < home_cand_num; c++)
     {
         borg_item *item;
         borg_item *item2;
-        bool stacked = FALSE;
+
+        i = home_cand[c];
 
         item = &borg_items[i];
         item2= &borg_shops[7].ware[n];
 
-        /* Skip empty items */
-        /* Require "aware" */
-        /* Require "known" */
-        if (!item->iqty || !item->kind || !item->aware)
-            continue;
-
-        /* Hack -- ignore "worthless" items */
-        if (!item->value) continue;
+        /* None left */
+        if (!item->iqty) continue;
 
-        if (i==weapon_swap && weapon_swap !=0) continue;
-        if (i==armour_swap && armour_swap !=0) continue;
+        /* Dominated by the same item earlier in the list */
+        if (home_cand_twin[c] >= start_c &&
+            borg_items[home_cand[home_cand_twin[c]]].iqty) continue;
 
         /* stacking? */
         if (borg_object_similar(item2, item))
         {
             item2->iqty++;
             item->iqty--;
-            stacked = TRUE;
         }
         else
         {
-            int k;
-            bool found_match = FALSE;
-
             /* eliminate items that would stack else where in the list. */
-            for (k = 0; k < STORE_INVEN_MAX; k++)
-            {
-                if (borg_object_similar(&safe_home[k], item))
-                {
-                    found_match = TRUE;
-                    break;
-                }
-            }
-            if (found_match)
-                continue;
+            if (home_cand_stacks[i]) continue;
 
             /* replace current item with this item */
             COPY(item2, item, borg_item);
@@ -510,7 +673,7 @@ static void borg_think_home_sell_aux2_slow(  int n, int start_i )
         test[n] = i + STORE_INVEN_MAX;
 
         /* Evaluate the possible item */
-        borg_think_home_sell_aux2_slow( n + 1, i+1 );
+        borg_think_home_sell_aux2_slow( n + 1, c + 1 );
 
         /* restore stuff */
         COPY(item2, &safe_home[n], borg_item);
@@ -791,14 +954,14 @@ static bool borg_think_home_sell_aux( bool save_best )
     *b_home_power = -1;
 
     /* find best combo for home. */
+    borg_think_home_sell_aux2_fast( 0, 0 );
+
+    /* then look for a better one, if allowed the time */
     if (borg_slow_optimizehome)
     {
+        borg_think_home_sell_aux2_prep();
         borg_think_home_sell_aux2_slow( 0, 0 );
     }
-    else
-    {
-        borg_think_home_sell_aux2_fast( 0, 0 );
-    }
 
     /* restore bonuses and such */
     for (i = 0; i < STORE_INVEN_MAX; i++)
@@ -2963,7 +3126,7 @@ bool borg_think_stair_scum(bool from_town)
           track_more_num++;
        }
        /* tell the array */
-       ag->feat = FEAT_MORE;
+       borg_set_feat(ag, FEAT_MORE);
 
 	}
 
@@ -2986,7 +3149,7 @@ bool borg_think_stair_scum(bool from_town)
        }
 
 		/* Tell the array */
-       ag->feat = FEAT_LESS;
+       borg_set_feat(ag, FEAT_LESS);
 
 	}
 
@@ -3220,7 +3383,7 @@ bool borg_think_dungeon_lunal(void)
           track_more_num++;
        }
        /* tell the array */
-       ag->feat = FEAT_MORE;
+       borg_set_feat(ag, FEAT_MORE);
 
 	}
 
@@ -3243,7 +3406,7 @@ bool borg_think_dungeon_lunal(void)
        }
 
 		/* Tell the array */
-       ag->feat = FEAT_LESS;
+       borg_set_feat(ag, FEAT_LESS);
 
 	}
 
@@ -3621,7 +3784,7 @@ bool borg_think_dungeon_munchkin(void)
           track_more_num++;
        }
        /* tell the array */
-       ag->feat = FEAT_MORE;
+       borg_set_feat(ag, FEAT_MORE);
 
 	}
 
@@ -3644,7 +3807,7 @@ bool borg_think_dungeon_munchkin(void)
        }
 
 		/* Tell the array */
-       ag->feat = FEAT_LESS;
+       borg_set_feat(ag, FEAT_LESS);
 
 	}
 
@@ -3959,7 +4122,7 @@ static bool borg_think_dungeon_brave(void)
 	    borg_defend(p1)) return TRUE;
 
     /* Attack monsters */
-    if (borg_attack(TRUE)) return (TRUE);
+    if (BORG_PROF_CALL(BORG_PROF_ATTACK, borg_attack(TRUE))) return (TRUE);
 
     /* Cast a light beam to remove fear of an area */
     if (borg_LIGHT_beam(FALSE)) return (TRUE);
@@ -4339,18 +4502,10 @@ bool borg_think_dungeon(void)
         (time_this_panel >= 500 && time_this_panel <= 503))
     {
         /* No objects here */
-        borg_takes_cnt = 0;
-        borg_takes_nxt = 1;
-
-        /* Forget old objects */
-        C_WIPE(borg_takes, 256, borg_take);
+        borg_forget_takes();
 
         /* No monsters here */
-        borg_kills_cnt = 0;
-        borg_kills_nxt = 1;
-
-        /* Forget old monsters */
-        C_WIPE(borg_kills, 256, borg_kill);
+        borg_forget_kills();
     }
     if (borg_skill[BI_CDEPTH] &&
         (time_this_panel >= 700))
@@ -4564,7 +4719,7 @@ bool borg_think_dungeon(void)
     /*** Important goals ***/
 
     /* Try not to die */
-    if (borg_caution()) return (TRUE);
+    if (BORG_PROF_CALL(BORG_PROF_CAUTION, borg_caution())) return (TRUE);
 
 	/*** if returning from dungeon in bad shape...***/
     if (borg_skill[BI_CURLITE] == 0 || borg_skill[BI_ISCUT] ||
@@ -4616,7 +4771,7 @@ bool borg_think_dungeon(void)
 	if (borg_items[INVEN_BOW].iqty && !borg_items[QUIVER_START].tval && borg_wear_quiver()) return (TRUE);
 
     /* Attack monsters */
-    if (borg_attack(FALSE)) return (TRUE);
+    if (BORG_PROF_CALL(BORG_PROF_ATTACK, borg_attack(FALSE))) return (TRUE);
 
     /* Wear things that need to be worn, but try to avoid swap loops */
     if (borg_wear_stuff()) return (TRUE);
@@ -5240,6 +5395,9 @@ bool borg_think_dungeon(void)
             }
         }
 
+        /* Forget the danger that came with it */
+        borg_danger_wipe_map();
+
         /* Forget goals */
         goal = 0;
 
@@ -5283,11 +5441,7 @@ bool borg_think_dungeon(void)
 		track_vein_num = 0;
 
         /* No objects here */
-        borg_takes_cnt = 0;
-        borg_takes_nxt = 1;
-
-        /* Forget old objects */
-        C_WIPE(borg_takes, 256, borg_take);
+        borg_forget_takes();
 
         /* Try anything */
         if (borg_think_dungeon_brave()) done = TRUE;
@@ -5380,19 +5534,14 @@ bool borg_think_dungeon(void)
             }
         }
 
-        /* No objects here */
-        borg_takes_cnt = 0;
-        borg_takes_nxt = 1;
+        /* Forget the danger that came with it */
+        borg_danger_wipe_map();
 
-        /* Forget old objects */
-        C_WIPE(borg_takes, 256, borg_take);
+        /* No objects here */
+        borg_forget_takes();
 
         /* No monsters here */
-        borg_kills_cnt = 0;
-        borg_kills_nxt = 1;
-
-        /* Forget old monsters */
-        C_WIPE(borg_kills, 256, borg_kill);
+        borg_forget_kills();
 
         /* Hack -- Forget race counters */
         C_WIPE(borg_race_count, z_info->r_max, s16b);
@@ -5415,7 +5564,8 @@ bool borg_think_dungeon(void)
  */
 void borg_init_8(void)
 {
-    /* Nothing */
+    /* Make the home optimizer memo */
+    C_MAKE(home_memo, BORG_HOME_MEMO_MAX, borg_home_memo);
 }
 
 
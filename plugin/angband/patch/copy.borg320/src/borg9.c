@@ -3,6 +3,7 @@
 /* Purpose: Highest level functions for the Borg -BEN- */
 #include "angband.h"
 #include "tvalsval.h"
+#include "files.h"
 
 #include "borg1.h"
 #include "borg2.h"
@@ -432,6 +433,7 @@ static bool borg_think(void)
 
 	/* Fill up the borg_skill[] array */
 	(void)borg_update_frame();
+	borg_threat_sync();
 
 	/*** Process inventory/equipment ***/
 
@@ -678,7 +680,9 @@ static bool borg_think(void)
         borg_do_spell_aux = 0;
 
         /* Examine the inventory */
+        BORG_PROF_ENTER(BORG_PROF_NOTICE);
         borg_notice(TRUE);
+        BORG_PROF_LEAVE(BORG_PROF_NOTICE);
 
         /* Evaluate the current world */
         my_power = borg_power();
@@ -690,7 +694,7 @@ static bool borg_think(void)
 		borg_in_shop = TRUE;
 
         /* Think until done */
-        return (borg_think_store());
+        return (BORG_PROF_CALL(BORG_PROF_STORE, borg_think_store()));
     }
 
 
@@ -782,10 +786,14 @@ static bool borg_think(void)
     time_this_panel++;
 
     /* Examine the screen */
+    BORG_PROF_ENTER(BORG_PROF_UPDATE);
     borg_update();
+    BORG_PROF_LEAVE(BORG_PROF_UPDATE);
 
     /* Examine the equipment/inventory */
+    BORG_PROF_ENTER(BORG_PROF_NOTICE);
     borg_notice(TRUE);
+    BORG_PROF_LEAVE(BORG_PROF_NOTICE);
 
 	/* Evaluate the current world */
     my_power = borg_power();
@@ -794,7 +802,7 @@ static bool borg_think(void)
     if (borg_cancel) return (TRUE);
 
     /* Do something */
-    return (borg_think_dungeon());
+    return (BORG_PROF_CALL(BORG_PROF_DUNGEON, borg_think_dungeon()));
 }
 
 
@@ -1060,6 +1068,202 @@ static cptr prefix_feeling[] =
 };
 
 
+/*
+ * Message matcher -- the tables above, compiled into two tries.
+ *
+ * The suffix tables are stored backwards from the end of the message,
+ * and the prefix tables forwards from the start, so one walk each way
+ * finds every pattern that matches.  For each table we keep the lowest
+ * index that matched, which is what the old loops found first.
+ *
+ * Define BORG_PARSE_CHECK to compare every answer with a plain walk
+ * over the tables and note any difference in the borg log.
+ */
+#define BORG_MSG_PAIN       0
+#define BORG_MSG_DIED       1
+#define BORG_MSG_BLINK      2
+#define BORG_MSG_HIT_BY     3
+#define BORG_MSG_SPELL      4
+#define BORG_MSG_SUFFIX     5   /* Tables before this are suffixes */
+#define BORG_MSG_KILL       5
+#define BORG_MSG_FEELING    6
+#define BORG_MSG_MAX        7
+
+static cptr *borg_msg_table[BORG_MSG_MAX] =
+{
+    suffix_pain,
+    suffix_died,
+    suffix_blink,
+    suffix_hit_by,
+    suffix_spell,
+    prefix_kill,
+    prefix_feeling
+};
+
+typedef struct borg_msg_node borg_msg_node;
+
+struct borg_msg_node
+{
+    char c;                     /* Character leading here */
+    s16b child;                 /* First child, or -1 */
+    s16b next;                  /* Next sibling, or -1 */
+    s16b hit[BORG_MSG_MAX];     /* Pattern ending here, or -1 */
+};
+
+/* Node 0 is the suffix root, node 1 the prefix root */
+static borg_msg_node *borg_msg_nodes;
+static int borg_msg_num;
+
+/* Matches for the message being parsed */
+static s16b borg_msg_hit[BORG_MSG_MAX];
+
+
+/*
+ * Find (or add) the child of a node for a character
+ */
+static int borg_msg_child(int n, char c, bool add)
+{
+    int k, t;
+
+    for (k = borg_msg_nodes[n].child; k >= 0; k = borg_msg_nodes[k].next)
+    {
+        if (borg_msg_nodes[k].c == c) return (k);
+    }
+
+    if (!add) return (-1);
+
+    /* Add it */
+    k = borg_msg_num++;
+    borg_msg_nodes[k].c = c;
+    borg_msg_nodes[k].child = -1;
+    borg_msg_nodes[k].next = borg_msg_nodes[n].child;
+    borg_msg_nodes[n].child = k;
+    for (t = 0; t < BORG_MSG_MAX; t++) borg_msg_nodes[k].hit[t] = -1;
+
+    return (k);
+}
+
+
+/*
+ * Build the tries
+ */
+static void borg_msg_init(void)
+{
+    int t, i, j, n, len;
+    int size = 2;
+
+    /* Room for every character of every pattern */
+    for (t = 0; t < BORG_MSG_MAX; t++)
+    {
+        for (i = 0; borg_msg_table[t][i]; i++)
+        {
+            size += strlen(borg_msg_table[t][i]);
+        }
+    }
+    C_MAKE(borg_msg_nodes, size, borg_msg_node);
+
+    /* The roots */
+    for (n = 0; n < 2; n++)
+    {
+        borg_msg_nodes[n].child = -1;
+        borg_msg_nodes[n].next = -1;
+        for (t = 0; t < BORG_MSG_MAX; t++) borg_msg_nodes[n].hit[t] = -1;
+    }
+    borg_msg_num = 2;
+
+    /* Add the patterns */
+    for (t = 0; t < BORG_MSG_MAX; t++)
+    {
+        for (i = 0; borg_msg_table[t][i]; i++)
+        {
+            cptr str = borg_msg_table[t][i];
+
+            len = strlen(str);
+
+            if (t < BORG_MSG_SUFFIX)
+            {
+                for (n = 0, j = len - 1; j >= 0; j--)
+                    n = borg_msg_child(n, str[j], TRUE);
+            }
+            else
+            {
+                for (n = 1, j = 0; j < len; j++)
+                    n = borg_msg_child(n, str[j], TRUE);
+            }
+
+            /* The first copy of a pattern wins */
+            if (borg_msg_nodes[n].hit[t] < 0) borg_msg_nodes[n].hit[t] = i;
+        }
+    }
+}
+
+
+/*
+ * Note a node in "borg_msg_hit[]"
+ */
+static void borg_msg_note(int n)
+{
+    int t;
+
+    for (t = 0; t < BORG_MSG_MAX; t++)
+    {
+        int i = borg_msg_nodes[n].hit[t];
+
+        if (i < 0) continue;
+        if (borg_msg_hit[t] < 0 || i < borg_msg_hit[t]) borg_msg_hit[t] = i;
+    }
+}
+
+
+/*
+ * Match a message against all the tables
+ */
+static void borg_msg_match(cptr msg)
+{
+    int t, j, n;
+    int len = strlen(msg);
+
+    for (t = 0; t < BORG_MSG_MAX; t++) borg_msg_hit[t] = -1;
+
+    /* Suffixes, from the end */
+    for (n = 0, j = len - 1; j >= 0; j--)
+    {
+        n = borg_msg_child(n, msg[j], FALSE);
+        if (n < 0) break;
+        borg_msg_note(n);
+    }
+
+    /* Prefixes, from the start */
+    for (n = 1, j = 0; j < len; j++)
+    {
+        n = borg_msg_child(n, msg[j], FALSE);
+        if (n < 0) break;
+        borg_msg_note(n);
+    }
+
+#ifdef BORG_PARSE_CHECK
+    for (t = 0; t < BORG_MSG_MAX; t++)
+    {
+        int i;
+
+        for (i = 0; borg_msg_table[t][i]; i++)
+        {
+            if ((t < BORG_MSG_SUFFIX) ? suffix(msg, borg_msg_table[t][i]) :
+                                        prefix(msg, borg_msg_table[t][i]))
+                break;
+        }
+        if (!borg_msg_table[t][i]) i = -1;
+
+        if (i != borg_msg_hit[t])
+        {
+            borg_note(format("# Message table %d mismatch: %d, not %d <%s>",
+                             t, borg_msg_hit[t], i, msg));
+        }
+    }
+#endif
+}
+
+
 
 /*
  * Hack -- Parse a message from the world
@@ -1114,6 +1318,9 @@ static void borg_parse_aux(cptr msg, int len)
     /* Log (if needed) */
 	if (borg_verbose) borg_note(format("# Parse Msg bite <%s>", msg));
 
+    /* Look it up in the message tables */
+    borg_msg_match(msg);
+
     /* Hack -- Notice death */
     if (prefix(msg, "You die."))
     {
@@ -1160,7 +1367,7 @@ static void borg_parse_aux(cptr msg, int len)
             if (borg_skill[BI_DIS] < 20)
             {
                 /* Set door as jammed, then bash it */
-                ag->feat = FEAT_DOOR_HEAD + 0x08;
+                borg_set_feat(ag, FEAT_DOOR_HEAD + 0x08);
             }
         }
 
@@ -1519,61 +1726,45 @@ static void borg_parse_aux(cptr msg, int len)
 	}
 
     /* "It screams in pain." (etc) */
-    for (i = 0; suffix_pain[i]; i++)
+    if ((i = borg_msg_hit[BORG_MSG_PAIN]) >= 0)
     {
-        /* "It screams in pain." (etc) */
-        if (suffix(msg, suffix_pain[i]))
-        {
-            tmp = strlen(suffix_pain[i]);
-            strnfmt(who, 1 + len - tmp, "%s", msg);
-            strnfmt(buf, 256, "PAIN:%^s", who);
-            borg_react(msg, buf);
-            return;
-        }
+        tmp = strlen(suffix_pain[i]);
+        strnfmt(who, 1 + len - tmp, "%s", msg);
+        strnfmt(buf, 256, "PAIN:%^s", who);
+        borg_react(msg, buf);
+        return;
     }
 
 
     /* "You have killed it." (etc) */
-    for (i = 0; prefix_kill[i]; i++)
+    if ((i = borg_msg_hit[BORG_MSG_KILL]) >= 0)
     {
-        /* "You have killed it." (etc) */
-        if (prefix(msg, prefix_kill[i]))
-        {
-            tmp = strlen(prefix_kill[i]);
-            strnfmt(who, 1 + len - (tmp + 1), "%s", msg + tmp);
-            strnfmt(buf, 256, "KILL:%^s", who);
-            borg_react(msg, buf);
-            return;
-        }
+        tmp = strlen(prefix_kill[i]);
+        strnfmt(who, 1 + len - (tmp + 1), "%s", msg + tmp);
+        strnfmt(buf, 256, "KILL:%^s", who);
+        borg_react(msg, buf);
+        return;
     }
 
 
     /* "It dies." (etc) */
-    for (i = 0; suffix_died[i]; i++)
+    if ((i = borg_msg_hit[BORG_MSG_DIED]) >= 0)
     {
-		/* "It dies." (etc) */
-        if (suffix(msg, suffix_died[i]))
-        {
-            tmp = strlen(suffix_died[i]);
-            strnfmt(who, 1 + len - tmp, "%s", msg);
-            strnfmt(buf, 256, "DIED:%^s", who);
-            borg_react(msg, buf);
-            return;
-        }
+        tmp = strlen(suffix_died[i]);
+        strnfmt(who, 1 + len - tmp, "%s", msg);
+        strnfmt(buf, 256, "DIED:%^s", who);
+        borg_react(msg, buf);
+        return;
     }
 
     /* "It blinks or telports." (etc) */
-    for (i = 0; suffix_blink[i]; i++)
+    if ((i = borg_msg_hit[BORG_MSG_BLINK]) >= 0)
     {
-        /* "It teleports." (etc) */
-        if (suffix(msg, suffix_blink[i]))
-        {
-            tmp = strlen(suffix_blink[i]);
-            strnfmt(who, 1 + len - tmp, "%s", msg);
-            strnfmt(buf, 256, "BLINK:%^s", who);
-            borg_react(msg, buf);
-            return;
-        }
+        tmp = strlen(suffix_blink[i]);
+        strnfmt(who, 1 + len - tmp, "%s", msg);
+        strnfmt(buf, 256, "BLINK:%^s", who);
+        borg_react(msg, buf);
+        return;
     }
 
     /* "It misses you." */
@@ -1598,60 +1789,52 @@ static void borg_parse_aux(cptr msg, int len)
     }
 
     /* "It hits you." (etc) */
-    for (i = 0; suffix_hit_by[i]; i++)
+    if ((i = borg_msg_hit[BORG_MSG_HIT_BY]) >= 0)
     {
-        /* "It hits you." (etc) */
-        if (suffix(msg, suffix_hit_by[i]))
-        {
-            tmp = strlen(suffix_hit_by[i]);
-            strnfmt(who, 1 + len - tmp, "%s", msg);
-            strnfmt(buf, 256, "HIT_BY:%^s", who);
-            borg_react(msg, buf);
+        tmp = strlen(suffix_hit_by[i]);
+        strnfmt(who, 1 + len - tmp, "%s", msg);
+        strnfmt(buf, 256, "HIT_BY:%^s", who);
+        borg_react(msg, buf);
 
-            /* If I was hit, then I am not on a glyph */
-            if (track_glyph_num)
+        /* If I was hit, then I am not on a glyph */
+        if (track_glyph_num)
+        {
+            /* erase them all and
+             * allow the borg to scan the screen and rebuild the array.
+             * He won't see the one under him though.  So a special check
+             * must be made.
+             */
+            byte feat = cave_feat[c_y][c_x];
+
+             /* Remove the entire array */
+             for (i = 0; i < track_glyph_num; i++)
+             {
+                 /* Stop if we already new about this glyph */
+                 track_glyph_x[i] = 0;
+                 track_glyph_y[i] = 0;
+             }
+             track_glyph_num = 0;
+
+            /* Check for glyphs under player -- Cheat*/
+            if (feat == FEAT_GLYPH)
             {
-                /* erase them all and
-                 * allow the borg to scan the screen and rebuild the array.
-                 * He won't see the one under him though.  So a special check
-                 * must be made.
-                 */
-                byte feat = cave_feat[c_y][c_x];
-
-                 /* Remove the entire array */
-                 for (i = 0; i < track_glyph_num; i++)
-                 {
-                     /* Stop if we already new about this glyph */
-                     track_glyph_x[i] = 0;
-                     track_glyph_y[i] = 0;
-                 }
-                 track_glyph_num = 0;
-
-                /* Check for glyphs under player -- Cheat*/
-                if (feat == FEAT_GLYPH)
-                {
-                    track_glyph_x[track_glyph_num] = c_x;
-                    track_glyph_y[track_glyph_num] = c_y;
-                    track_glyph_num++;
-                }
+                track_glyph_x[track_glyph_num] = c_x;
+                track_glyph_y[track_glyph_num] = c_y;
+                track_glyph_num++;
             }
-            return;
         }
+        return;
     }
 
 
     /* "It casts a spell." (etc) */
-    for (i = 0; suffix_spell[i]; i++)
+    if ((i = borg_msg_hit[BORG_MSG_SPELL]) >= 0)
     {
-        /* "It casts a spell." (etc) */
-        if (suffix(msg, suffix_spell[i]))
-        {
-            tmp = strlen(suffix_spell[i]);
-            strnfmt(who, 1 + len - tmp, "%s", msg);
-            strnfmt(buf, 256, "SPELL_%03d:%^s", i, who);
-            borg_react(msg, buf);
-            return;
-        }
+        tmp = strlen(suffix_spell[i]);
+        strnfmt(who, 1 + len - tmp, "%s", msg);
+        strnfmt(buf, 256, "SPELL_%03d:%^s", i, who);
+        borg_react(msg, buf);
+        return;
     }
 
 
@@ -1742,7 +1925,7 @@ static void borg_parse_aux(cptr msg, int len)
         if (ag->feat == FEAT_OPEN)
         {
             /* Mark as broken */
-            ag->feat = FEAT_BROKEN;
+            borg_set_feat(ag, FEAT_BROKEN);
 
             /* Clear goals */
             goal = 0;
@@ -1757,7 +1940,7 @@ static void borg_parse_aux(cptr msg, int len)
         if ((ag->feat >= FEAT_DOOR_HEAD) && (ag->feat <= FEAT_DOOR_HEAD + 0x07))
         {
             /* Mark the door as jammed */
-            ag->feat = FEAT_DOOR_HEAD + 0x08;
+            borg_set_feat(ag, FEAT_DOOR_HEAD + 0x08);
 
             /* Clear goals */
             goal = 0;
@@ -1775,7 +1958,7 @@ static void borg_parse_aux(cptr msg, int len)
         if ((ag->feat >= FEAT_WALL_EXTRA) && (ag->feat <= FEAT_PERM_SOLID))
         {
             /* Mark the wall as permanent */
-            ag->feat = FEAT_PERM_EXTRA;
+            borg_set_feat(ag, FEAT_PERM_EXTRA);
 
             /* Clear goals */
             goal = 0;
@@ -1794,7 +1977,7 @@ static void borg_parse_aux(cptr msg, int len)
         if ((ag->feat >= FEAT_WALL_EXTRA) && (ag->feat <= FEAT_PERM_SOLID))
         {
             /* Mark the wall as granite */
-            ag->feat = FEAT_WALL_EXTRA;
+            borg_set_feat(ag, FEAT_WALL_EXTRA);
 
             /* Clear goals */
             goal = 0;
@@ -1811,7 +1994,7 @@ static void borg_parse_aux(cptr msg, int len)
         if (ag->feat == FEAT_MAGMA_K)
         {
             /* Mark the vein */
-            ag->feat = FEAT_QUARTZ_K;
+            borg_set_feat(ag, FEAT_QUARTZ_K);
 
             /* Clear goals */
             goal = 0;
@@ -1821,7 +2004,7 @@ static void borg_parse_aux(cptr msg, int len)
         else if (ag->feat == FEAT_MAGMA)
         {
             /* Mark the vein */
-            ag->feat = FEAT_QUARTZ;
+            borg_set_feat(ag, FEAT_QUARTZ);
 
             /* Clear goals */
             goal = 0;
@@ -1837,7 +2020,7 @@ static void borg_parse_aux(cptr msg, int len)
         if (ag->feat == FEAT_QUARTZ_K)
         {
             /* Mark the vein */
-            ag->feat = FEAT_MAGMA_K;
+            borg_set_feat(ag, FEAT_MAGMA_K);
 
             /* Clear goals */
             goal = 0;
@@ -1847,7 +2030,7 @@ static void borg_parse_aux(cptr msg, int len)
         else if (ag->feat == FEAT_QUARTZ)
         {
             /* Mark the vein */
-            ag->feat = FEAT_MAGMA;
+            borg_set_feat(ag, FEAT_MAGMA);
 
             /* Clear goals */
             goal = 0;
@@ -2028,12 +2211,12 @@ static void borg_parse_aux(cptr msg, int len)
 		/* make sure the borg does not think he's on one */
         if (borg_on_dnstairs)
         {
-            ag->feat = FEAT_FLOOR;
+            borg_set_feat(ag, FEAT_FLOOR);
             borg_on_dnstairs = FALSE;
         }
         if (borg_on_upstairs)
         {
-            ag->feat = FEAT_FLOOR;
+            borg_set_feat(ag, FEAT_FLOOR);
             borg_on_upstairs = FALSE;
         }
 
@@ -2043,7 +2226,7 @@ static void borg_parse_aux(cptr msg, int len)
     /* Feature XXX XXX XXX */
     if (prefix(msg, "You see nothing there "))
     {
-        ag->feat = FEAT_BROKEN;
+        borg_set_feat(ag, FEAT_BROKEN);
 
         my_no_alter = TRUE;
         /* Clear goals */
@@ -2244,7 +2427,7 @@ static void borg_parse_aux(cptr msg, int len)
         /* mark that we are not on a clear spot.  The borg ignores
          * broken doors and this will keep him from casting it again.
          */
-        ag->feat = FEAT_BROKEN;
+        borg_set_feat(ag, FEAT_BROKEN);
         return;
     }
 
@@ -2336,15 +2519,11 @@ static void borg_parse_aux(cptr msg, int len)
     }
 
 	/* Feelings about the level */
-    for (i = 0; prefix_feeling[i]; i++)
+    if ((i = borg_msg_hit[BORG_MSG_FEELING]) >= 0)
     {
-        /* "You feel..." (etc) */
-        if (prefix(msg, prefix_feeling[i]))
-        {
-            strnfmt(buf, 256, "FEELING:%d", i);
-            borg_react(msg, buf);
-            return;
-        }
+        strnfmt(buf, 256, "FEELING:%d", i);
+        borg_react(msg, buf);
+        return;
     }
 }
 
@@ -3377,7 +3556,404 @@ extern char (*inkey_hack)(int flush_first);
  * the game has asked for the next keypress, but the various "keypress"
  * routines should be able to handle this.
  */
-static char borg_inkey_hack(int flush_first)
+/*
+ * Turbo mode.
+ *
+ * The hooks of the main term are swapped for versions which do nothing,
+ * so the game only updates the "Term->scr" arrays (which is all that the
+ * Borg reads, see "borg_what_text()") and never touches the real display,
+ * nor sleeps for "TERM_XTRA_DELAY".  Every "borg_turbo_snapshot" game turns
+ * the real hooks are put back for one complete redraw, and they are put
+ * back for good when the Borg lets go of the keyboard.
+ */
+static bool borg_turbo_on = FALSE;
+
+static errr (*turbo_xtra_hook)(int n, int v);
+static errr (*turbo_curs_hook)(int x, int y);
+static errr (*turbo_wipe_hook)(int x, int y, int n);
+static errr (*turbo_text_hook)(int x, int y, int n, byte a, cptr s);
+static errr (*turbo_pict_hook)(int x, int y, int n, const byte *ap,
+                               const char *cp, const byte *tap, const char *tcp);
+
+static errr borg_turbo_xtra(int n, int v)
+{
+    switch (n)
+    {
+        /* Skip anything which draws or waits */
+        case TERM_XTRA_CLEAR:
+        case TERM_XTRA_SHAPE:
+        case TERM_XTRA_FROSH:
+        case TERM_XTRA_FRESH:
+        case TERM_XTRA_NOISE:
+        case TERM_XTRA_DELAY:
+        return (0);
+    }
+
+    /* Still look for keypresses, so the user can stop the Borg */
+    return ((*turbo_xtra_hook)(n, v));
+}
+
+static errr borg_turbo_curs(int x, int y)
+{
+    return (0);
+}
+
+static errr borg_turbo_wipe(int x, int y, int n)
+{
+    return (0);
+}
+
+static errr borg_turbo_text(int x, int y, int n, byte a, cptr s)
+{
+    return (0);
+}
+
+static errr borg_turbo_pict(int x, int y, int n, const byte *ap,
+                            const char *cp, const byte *tap, const char *tcp)
+{
+    return (0);
+}
+
+static void borg_turbo_engage(void)
+{
+    term *t = angband_term[0];
+
+    if (borg_turbo_on || !t) return;
+
+    turbo_xtra_hook = t->xtra_hook;
+    turbo_curs_hook = t->curs_hook;
+    turbo_wipe_hook = t->wipe_hook;
+    turbo_text_hook = t->text_hook;
+    turbo_pict_hook = t->pict_hook;
+
+    t->xtra_hook = borg_turbo_xtra;
+    t->curs_hook = borg_turbo_curs;
+    t->wipe_hook = borg_turbo_wipe;
+    t->text_hook = borg_turbo_text;
+    t->pict_hook = borg_turbo_pict;
+
+    borg_turbo_on = TRUE;
+}
+
+static void borg_turbo_release(void)
+{
+    term *old = Term;
+    term *t = angband_term[0];
+
+    if (!borg_turbo_on) return;
+
+    t->xtra_hook = turbo_xtra_hook;
+    t->curs_hook = turbo_curs_hook;
+    t->wipe_hook = turbo_wipe_hook;
+    t->text_hook = turbo_text_hook;
+    t->pict_hook = turbo_pict_hook;
+
+    borg_turbo_on = FALSE;
+
+    /* The display is stale, so redraw all of it */
+    Term_activate(t);
+    Term_redraw();
+    Term_activate(old);
+}
+
+/*
+ * Refresh the screen, or in turbo mode, take a snapshot now and then.
+ */
+static void borg_fresh(void)
+{
+    static s32b turbo_turn = 0;
+
+    /* Normal mode */
+    if (!borg_turbo)
+    {
+        borg_turbo_release();
+        Term_fresh();
+        return;
+    }
+
+    borg_turbo_engage();
+
+    /* New game */
+    if (turn < turbo_turn) turbo_turn = turn;
+
+    /* Snapshot */
+    if (borg_turbo_snapshot && turn >= turbo_turn + borg_turbo_snapshot)
+    {
+        turbo_turn = turn;
+        borg_turbo_release();
+        borg_turbo_engage();
+    }
+}
+
+/*
+ * Session journal.  Recording saves the game, keeps a copy of the
+ * savefile, and writes the borg seed and every key the borg hands to
+ * the game.  Replaying, with that savefile loaded into a fresh game,
+ * runs the borg again and checks each key against the journal.  The
+ * game's own random state travels in the savefile.  Both modes write
+ * the wall time spent on each game turn, so two runs of the same
+ * journal can be compared.
+ */
+static ang_file *borg_journal_file = NULL;     /* Keys */
+static ang_file *borg_journal_time = NULL;     /* Times per game turn */
+static s32b borg_journal_turn;                 /* Game turn being timed */
+static u32b borg_journal_start;                /* When it began */
+static u32b borg_journal_keys;                 /* Keys so far */
+static u32b borg_journal_turns;                /* Game turns timed */
+static double borg_journal_usec;               /* Time spent in them */
+
+
+/*
+ * Copy a file, for the savefile
+ */
+static bool borg_journal_copy(cptr from, cptr to)
+{
+    ang_file *fin, *fout;
+    char buf[1024];
+    int n;
+    bool ok = TRUE;
+
+    fin = file_open(from, MODE_READ, -1);
+    if (!fin) return (FALSE);
+
+    fout = file_open(to, MODE_WRITE, FTYPE_SAVE);
+    if (!fout)
+    {
+        file_close(fin);
+        return (FALSE);
+    }
+
+    while ((n = file_read(fin, buf, sizeof(buf))) > 0)
+    {
+        if (!file_write(fout, buf, n)) ok = FALSE;
+    }
+
+    file_close(fin);
+    file_close(fout);
+
+    return (ok);
+}
+
+
+/*
+ * Open the timing file for a journal
+ */
+static bool borg_journal_open_time(cptr name)
+{
+    char buf[1024];
+
+    path_build(buf, 1024, ANGBAND_DIR_USER, name);
+
+    borg_journal_time = file_open(buf, MODE_WRITE, FTYPE_TEXT);
+    if (!borg_journal_time) return (FALSE);
+
+    file_putf(borg_journal_time, "# game turn, microseconds\n");
+
+    borg_journal_turn = turn;
+    borg_journal_start = borg_usec();
+    borg_journal_keys = 0;
+    borg_journal_turns = 0;
+    borg_journal_usec = 0;
+
+    return (TRUE);
+}
+
+
+/*
+ * Close the journal, with a summary of the times
+ */
+static void borg_journal_stop(cptr why)
+{
+    if (!borg_journal) return;
+
+    if (borg_journal_time)
+    {
+        file_putf(borg_journal_time, "# %s\n", why);
+        file_putf(borg_journal_time, "# keys %lu, game turns %lu, total %.0f usec",
+                  (unsigned long)borg_journal_keys,
+                  (unsigned long)borg_journal_turns, borg_journal_usec);
+        if (borg_journal_turns)
+            file_putf(borg_journal_time, ", mean %.1f usec per turn",
+                      borg_journal_usec / borg_journal_turns);
+        file_putf(borg_journal_time, "\n");
+        file_close(borg_journal_time);
+        borg_journal_time = NULL;
+    }
+
+    if (borg_journal_file)
+    {
+        file_close(borg_journal_file);
+        borg_journal_file = NULL;
+    }
+
+    borg_note(format("# Journal closed (%s) after %lu keys.", why,
+                     (unsigned long)borg_journal_keys));
+
+    borg_journal = 0;
+}
+
+
+/*
+ * Start recording.  Must come before anything else wakes the borg, as
+ * waking it draws on the game's random numbers.
+ */
+static bool borg_journal_record(void)
+{
+    char buf[1024];
+
+    /* Save the game, and keep a copy */
+    save_game();
+    path_build(buf, 1024, ANGBAND_DIR_USER, "borg-replay.sav");
+    safe_setuid_drop();
+    if (!borg_journal_copy(savefile, buf))
+    {
+        safe_setuid_grab();
+        msg_print("Could not copy the savefile.");
+        return (FALSE);
+    }
+
+    /* Wake the borg */
+    borg_init_9();
+
+    path_build(buf, 1024, ANGBAND_DIR_USER, "borg-replay.txt");
+    borg_journal_file = file_open(buf, MODE_WRITE, FTYPE_TEXT);
+    if (!borg_journal_file || !borg_journal_open_time("borg-record-time.txt"))
+    {
+        if (borg_journal_file) file_close(borg_journal_file);
+        borg_journal_file = NULL;
+        safe_setuid_grab();
+        msg_print("Could not write the journal.");
+        return (FALSE);
+    }
+    safe_setuid_grab();
+
+    file_putf(borg_journal_file, "# borg journal, replay from borg-replay.sav\n");
+    file_putf(borg_journal_file, "turn %ld\n", (long)turn);
+    file_putf(borg_journal_file, "seed %lu\n", (unsigned long)borg_rand_local);
+
+    borg_journal = BORG_JOURNAL_RECORD;
+
+    return (TRUE);
+}
+
+
+/*
+ * Start replaying, from the savefile the journal was recorded with
+ */
+static bool borg_journal_play(void)
+{
+    char buf[1024];
+    long t = -1;
+    unsigned long seed = 0;
+
+    path_build(buf, 1024, ANGBAND_DIR_USER, "borg-replay.txt");
+    safe_setuid_drop();
+    borg_journal_file = file_open(buf, MODE_READ, -1);
+    safe_setuid_grab();
+    if (!borg_journal_file)
+    {
+        msg_print("Could not read borg-replay.txt.");
+        return (FALSE);
+    }
+
+    /* Read the header */
+    while (file_getl(borg_journal_file, buf, sizeof(buf)))
+    {
+        if (buf[0] == '#') continue;
+        if (sscanf(buf, "turn %ld", &t) == 1) continue;
+        if (sscanf(buf, "seed %lu", &seed) == 1) break;
+    }
+
+    /* The journal starts from its own savefile */
+    if (t != (long)turn || !seed)
+    {
+        file_close(borg_journal_file);
+        borg_journal_file = NULL;
+        msg_print("Load borg-replay.sav first.");
+        return (FALSE);
+    }
+
+    /* Wake the borg, then give it the recorded seed */
+    borg_init_9();
+    borg_rand_local = (u32b)seed;
+
+    safe_setuid_drop();
+    if (!borg_journal_open_time("borg-replay-time.txt"))
+    {
+        safe_setuid_grab();
+        file_close(borg_journal_file);
+        borg_journal_file = NULL;
+        msg_print("Could not write borg-replay-time.txt.");
+        return (FALSE);
+    }
+    safe_setuid_grab();
+
+    borg_journal = BORG_JOURNAL_PLAY;
+
+    return (TRUE);
+}
+
+
+/*
+ * Record, or check, one key handed to the game
+ */
+static void borg_journal_key(char ch)
+{
+    char buf[80];
+    long t;
+    int k;
+    u32b now;
+
+    /* The borg went to sleep */
+    if (!borg_active)
+    {
+        borg_journal_stop("borg stopped");
+        return;
+    }
+
+    /* Time the game turn just finished */
+    if (turn != borg_journal_turn)
+    {
+        now = borg_usec();
+        file_putf(borg_journal_time, "%ld %lu\n", (long)borg_journal_turn,
+                  (unsigned long)(now - borg_journal_start));
+        borg_journal_usec += (now - borg_journal_start);
+        borg_journal_turns++;
+        borg_journal_turn = turn;
+        borg_journal_start = now;
+    }
+
+    borg_journal_keys++;
+
+    /* Record */
+    if (borg_journal == BORG_JOURNAL_RECORD)
+    {
+        file_putf(borg_journal_file, "key %ld %d\n", (long)turn, (byte)ch);
+        return;
+    }
+
+    /* Replay ran off the end */
+    if (!file_getl(borg_journal_file, buf, sizeof(buf)) ||
+        sscanf(buf, "key %ld %d", &t, &k) != 2)
+    {
+        borg_journal_stop("replay complete");
+        borg_oops("replay complete");
+        return;
+    }
+
+    /* Same choice, at the same time */
+    if (t != (long)turn || k != (byte)ch)
+    {
+        borg_note(format("# Replay diverged at key %lu: turn %ld key %d, recorded turn %ld key %d.",
+                         (unsigned long)borg_journal_keys, (long)turn,
+                         (byte)ch, t, k));
+        borg_journal_stop("replay diverged");
+        borg_oops("replay diverged");
+    }
+}
+
+
+static char borg_inkey_hack_aux(int flush_first)
 {
     char borg_ch;
 
@@ -3397,14 +3973,20 @@ static char borg_inkey_hack(int flush_first)
      (void)Term_locate(&x, &y);
 
     /* Refresh the screen */
-    Term_fresh();
+    borg_fresh();
 
     /* Deactivate */
     if (!borg_active)
     {
+        /* Put the display back */
+        borg_turbo_release();
+
         /* Message */
         borg_note("# Removing keypress hook");
 
+        /* Show the last notes */
+        borg_note_flush();
+
         /* Remove hook */
         inkey_hack = NULL;
 
@@ -3671,11 +4253,14 @@ static char borg_inkey_hack(int flush_first)
 
 
     /* Think */
-    while (!borg_think()) /* loop */;
+    while (!BORG_PROF_CALL(BORG_PROF_THINK, borg_think())) /* loop */;
 
     /* DVE- Update the status screen */
     borg_status();
 
+    /* Show this turn's notes */
+    borg_note_flush();
+
     /* Save the local random info */
     borg_rand_local = Rand_value;
 
@@ -3701,6 +4286,18 @@ static char borg_inkey_hack(int flush_first)
     return (ESCAPE);
 }
 
+/*
+ * Steal a keypress for the game, journaling it when asked
+ */
+static char borg_inkey_hack(int flush_first)
+{
+    char ch = borg_inkey_hack_aux(flush_first);
+
+    if (borg_journal) borg_journal_key(ch);
+
+    return (ch);
+}
+
 /*
  * Output a long int in binary format.
  */
@@ -4457,6 +5054,7 @@ void init_borg_txt_file(void)
         borg_kills_uniques = FALSE;
         borg_uses_swaps = TRUE;
         borg_slow_optimizehome = FALSE;
+        borg_home_budget = 250;
         borg_stop_dlevel = 128;
         borg_stop_clevel = 55;
 		borg_no_deeper = 127;
@@ -4472,7 +5070,10 @@ void init_borg_txt_file(void)
 		borg_lunal_mode = FALSE;
 		borg_self_lunal = TRUE;
 		borg_verbose = FALSE;
+		borg_note_mask = BORG_NOTE_ALL;
 		borg_munchkin_start = FALSE;
+		borg_turbo = FALSE;
+		borg_turbo_snapshot = 0;
 
         return;
     }
@@ -4586,9 +5187,12 @@ void init_borg_txt_file(void)
                 buf[strlen("borg_slow_optimizehome =")+1] == '1' ||
                 buf[strlen("borg_slow_optimizehome =")+1] == 't') borg_slow_optimizehome=TRUE;
             else borg_slow_optimizehome = FALSE;
+            continue;
+        }
 
-            /* for now always leave as false since its broken */
-            borg_slow_optimizehome = FALSE;
+        if (prefix(buf, "borg_home_budget ="))
+        {
+            sscanf(buf+strlen("borg_home_budget =")+1, "%d", &borg_home_budget);
             continue;
         }
 
@@ -4656,6 +5260,12 @@ void init_borg_txt_file(void)
             continue;
         }
 
+        if (prefix(buf, "borg_note_mask ="))
+        {
+            sscanf(buf+strlen("borg_note_mask =")+1, "%d", &borg_note_mask);
+            continue;
+        }
+
         if (prefix(buf, "borg_munchkin_start ="))
         {
             if (buf[strlen("borg_munchkin_start =")+1] == 'T' ||
@@ -4665,6 +5275,15 @@ void init_borg_txt_file(void)
             continue;
         }
 
+        if (prefix(buf, "borg_turbo ="))
+        {
+            if (buf[strlen("borg_turbo =")+1] == 'T' ||
+                buf[strlen("borg_turbo =")+1] == '1' ||
+                buf[strlen("borg_turbo =")+1] == 't') borg_turbo = TRUE;
+            else borg_turbo = FALSE;
+            continue;
+        }
+
 		/* Extract the integers */
         if (prefix(buf, "borg_respawn_race ="))
         {
@@ -4719,6 +5338,11 @@ void init_borg_txt_file(void)
             sscanf(buf+strlen("borg_money_scum_amount =")+1, "%d",  &borg_money_scum_amount);
             continue;
         }
+        if (prefix(buf, "borg_turbo_snapshot ="))
+        {
+            sscanf(buf+strlen("borg_turbo_snapshot =")+1, "%d", &borg_turbo_snapshot);
+            continue;
+        }
         if (prefix(buf, "REQ"))
         {
             if (!borg_load_requirement(buf+strlen("REQ")))
@@ -4786,6 +5410,9 @@ void borg_init_9(void)
     C_MAKE(borg_power_item, z_info->c_max, power_item*);
     C_MAKE(n_pwr, z_info->c_max, int);
 
+    /* Compile the message tables */
+    borg_msg_init();
+
 
     /*** Hack -- initialize borg.ini options ***/
 
@@ -5345,7 +5972,8 @@ void borg_write_map(bool ask)
     file_putf(borg_map_file, "borg_worships_ac; %d\n",borg_worships_ac);
     file_putf(borg_map_file, "borg_worships_gold; %d\n",borg_worships_gold);
     file_putf(borg_map_file, "borg_plays_risky; %d\n",borg_plays_risky);
-    file_putf(borg_map_file, "borg_slow_optimizehome; %d\n\n",borg_slow_optimizehome);
+    file_putf(borg_map_file, "borg_slow_optimizehome; %d\n",borg_slow_optimizehome);
+    file_putf(borg_map_file, "borg_home_budget; %d\n\n",borg_home_budget);
     file_putf(borg_map_file, "borg_scumming_pots; %d\n\n",borg_scumming_pots);
     file_putf(borg_map_file, "\n\n");
 
@@ -5941,6 +6569,14 @@ void borg_status(void)
    attr = TERM_WHITE;
    Term_putstr(56, 8, -1, attr,format("%d    ", borg_skill[BI_MAXDEPTH]));
 
+   /* Allocator use */
+   attr = TERM_SLATE;
+   Term_putstr(42, 9, -1, attr,"Allocs:");
+   attr = TERM_WHITE;
+   Term_putstr(50, 9, -1, attr,format("%lu (%lu bytes), %lu freed    ",
+               (unsigned long)mem_alloc_num, (unsigned long)mem_alloc_bytes,
+               (unsigned long)mem_free_num));
+
     /* Important endgame information */
    if (borg_skill[BI_MAXDEPTH] >= 50) /* 85 */
    {
@@ -6098,6 +6734,11 @@ void do_cmd_borg(void)
         Term_putstr(2, i++, -1, TERM_WHITE, "Command 'R' Respawn Borg.");
         Term_putstr(42, i, -1, TERM_WHITE, "Command 'o' Object Flags.");
         Term_putstr(2, i++, -1, TERM_WHITE, "Command 'r' Restock Stores.");
+#ifdef BORG_PROFILE
+        Term_putstr(42, i, -1, TERM_WHITE, "Command 'e' Profile dump/reset.");
+#endif
+        i++;
+        Term_putstr(2, i++, -1, TERM_WHITE, "Command 'j' Record/replay a session.");
 
         /* Prompt for key */
         msg_print("Commands: ");
@@ -6111,6 +6752,37 @@ void do_cmd_borg(void)
     }
 
 
+    /* Record or replay, which must wake the borg itself */
+    if (cmd == 'j')
+    {
+        if (!get_com("Borg journal: (r)ecord, (p)lay borg-replay.txt, (s)top ", &cmd)) return;
+
+        if (cmd == 's' || cmd == 'S')
+        {
+            borg_journal_stop("stopped by user");
+            return;
+        }
+
+        /* A journal starts with the borg */
+        if (initialized)
+        {
+            msg_print("Journals must start before the borg wakes; restart the game.");
+            return;
+        }
+
+        if (cmd == 'r' || cmd == 'R')
+        {
+            if (borg_journal_record())
+                msg_print("Recording to borg-replay.txt; 'z' to start the borg.");
+        }
+        else if (cmd == 'p' || cmd == 'P')
+        {
+            if (borg_journal_play())
+                msg_print("Replaying borg-replay.txt; 'z' to start the borg.");
+        }
+        return;
+    }
+
     /* Hack -- force initialization */
     if (!initialized) borg_init_9();
 
@@ -7024,8 +7696,41 @@ void do_cmd_borg(void)
             msg_format("; from town (%d)", time);
             msg_format("; on this panel (%d)", time_this_panel);
             msg_format("; need inviso (%d)", need_see_inviso);
+            msg_format("; flows cached (%d) built (%d)", borg_flow_hits, borg_flow_builds);
+            msg_format("; map grids (%d) examined (%d) changed (%d)",
+                       borg_map_cells, borg_map_examined, borg_map_changed);
+            msg_format("; projections cached (%d) traced (%d)",
+                       borg_proj_hits, borg_proj_misses);
+            msg_format("; launches shared (%d) traced (%d)",
+                       borg_launch_shared, borg_launch_traced);
+            msg_format("; prepared depths cached (%d) worked out (%d)",
+                       borg_prep_hits, borg_prep_misses);
+            break;
+        }
+
+#ifdef BORG_PROFILE
+        /* Command: dump or reset the profile */
+        case 'e':
+        {
+            char cmd;
+
+            if (!get_com("Borg profile: (d)ump to borg-prof.txt, (r)eset ", &cmd)) return;
+
+            if (cmd == 'd' || cmd == 'D')
+            {
+                if (borg_prof_dump("borg-prof.txt"))
+                    msg_print("Profile written to borg-prof.txt.");
+                else
+                    msg_print("Could not write borg-prof.txt.");
+            }
+            else if (cmd == 'r' || cmd == 'R')
+            {
+                borg_prof_reset();
+                msg_print("Profile reset.");
+            }
             break;
         }
+#endif /* BORG_PROFILE */
 
         /* Command: LOS */
         case '@':
@@ -46,6 +46,11 @@ bool arg_graphics_nice;			/* Command arg -- Request nice graphics mode */
 #ifdef ALLOW_BORG
 /* Screensaver borg things.   apw*/
 bool screensaver = FALSE;
+
+/* Allocations made through the z-virt.h macros */
+u32b mem_alloc_num = 0;
+u32b mem_alloc_bytes = 0;
+u32b mem_free_num = 0;
 #endif /* ALLOW_BORG */
 
 /*
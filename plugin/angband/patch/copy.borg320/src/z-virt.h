@@ -31,13 +31,27 @@
 	(memcpy((P1), (P2), sizeof(T)))
 
 
+#ifdef ALLOW_BORG
+/* Count the allocations and frees made through these macros */
+extern u32b mem_alloc_num;
+extern u32b mem_alloc_bytes;
+extern u32b mem_free_num;
+#define MEM_COUNT_ALLOC(L) \
+	(mem_alloc_num++, mem_alloc_bytes += (u32b)(L))
+#define MEM_COUNT_FREE(P) \
+	(mem_free_num += ((P) != NULL))
+#else
+#define MEM_COUNT_ALLOC(L) ((void)0)
+#define MEM_COUNT_FREE(P) ((void)0)
+#endif
+
 /* Allocate, and return, an array of type T[N] */
 #define C_RNEW(N, T) \
-	(T*)(mem_alloc((N) * sizeof(T)))
+	(T*)(MEM_COUNT_ALLOC((N) * sizeof(T)), mem_alloc((N) * sizeof(T)))
 
 /* Allocate, and return, a thing of type T */
 #define RNEW(T) \
-	(T*)(mem_alloc(sizeof(T)))
+	(T*)(MEM_COUNT_ALLOC(sizeof(T)), mem_alloc(sizeof(T)))
 
 
 /* Allocate, wipe, and return an array of type T[N] */
@@ -50,7 +64,7 @@
 
 
 /* Free one thing at P, return NULL */
-#define FREE(P) (mem_free(P), P = NULL)
+#define FREE(P) (MEM_COUNT_FREE(P), mem_free(P), P = NULL)
 
 #ifdef ALLOW_BORG
 /* Allocate a wiped array of type T[N], assign to pointer P */
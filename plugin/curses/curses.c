@@ -1,4 +1,5 @@
 #include <stdlib.h>
+#include <string.h>
 #include <wchar.h>
 #include "curses.h"
 
@@ -10,6 +11,17 @@
 WINDOW _win[WIN_MAX];
 WINDOW* stdscr = &_win[0];
 
+/* packed dirty runs: row, col, attr (2 bytes), n, then n UTF-16 chars */
+#define RUN_HDR 5
+#define RUN_BUF_SIZE (LINES*COLS*(RUN_HDR+2))
+static jbyte run_buf[RUN_BUF_SIZE];
+static jobject run_buf_obj;
+
+#ifndef MAX
+#define MAX(a,b) ((a) > (b) ? (a) : (b))
+#define MIN(a,b) ((a) < (b) ? (a) : (b))
+#endif
+
 #define LOGC(...) 
 //#define LOGC(...) __android_log_print(ANDROID_LOG_DEBUG  , "Angband", __VA_ARGS__)
 
@@ -25,30 +37,18 @@ static jobject NativeWrapperObj;
 /* Java Methods */
 static jmethodID NativeWrapper_fatal;
 static jmethodID NativeWrapper_warn;
-static jmethodID NativeWrapper_waddnstr;
-static jmethodID NativeWrapper_wattrset;
-static jmethodID NativeWrapper_wattrget;
-static jmethodID NativeWrapper_overwrite;
+static jmethodID NativeWrapper_wflush;
 static jmethodID NativeWrapper_touchwin;
-static jmethodID NativeWrapper_whline;
-static jmethodID NativeWrapper_wclear;
-static jmethodID NativeWrapper_wclrtoeol;
-static jmethodID NativeWrapper_wclrtobot;
 static jmethodID NativeWrapper_noise;
 static jmethodID NativeWrapper_init_color;
 static jmethodID NativeWrapper_init_pair;
 static jmethodID NativeWrapper_initscr;
 static jmethodID NativeWrapper_newwin;
 static jmethodID NativeWrapper_delwin;
-static jmethodID NativeWrapper_scroll;
 static jmethodID NativeWrapper_wrefresh;
 static jmethodID NativeWrapper_getch;
-static jmethodID NativeWrapper_wmove;
-static jmethodID NativeWrapper_mvwinch;
 static jmethodID NativeWrapper_curs_set;
 static jmethodID NativeWrapper_flushinp;
-static jmethodID NativeWrapper_getcury;
-static jmethodID NativeWrapper_getcurx;
 // #ifdef ANGDROID_NIGHTLY
 static jmethodID NativeWrapper_wctomb;
 static jmethodID NativeWrapper_mbstowcs;
@@ -60,12 +60,130 @@ static jmethodID NativeWrapper_score_submit;
 
 void (*angdroid_quit_hook)(void) = NULL;
 
+/*
+ * Native shadow screen.  These mirror the semantics of TermWindow.java
+ * so that Java only has to replay the dirty runs on wrefresh().  The
+ * shadow is authoritative: cursor, attribute and cell queries are all
+ * answered from it without calling back into the JVM.
+ */
+static void win_init(WINDOW *w, int k, int rows, int cols,
+					 int begin_y, int begin_x) {
+	int r, c;
+
+	if (rows <= 0 || rows > LINES) rows = LINES;
+	if (cols <= 0 || cols > COLS) cols = COLS;
+
+	w->w = k;
+	w->rows = rows;
+	w->cols = cols;
+	w->begy = begin_y;
+	w->begx = begin_x;
+	w->cury = w->curx = 0;
+	w->attr = 0;
+	for(r=0; r<rows; r++) {
+		for(c=0; c<cols; c++) {
+			w->ch[r][c] = ' ';
+			w->at[r][c] = 0;
+		}
+		w->firstch[r] = cols;
+		w->lastch[r] = -1;
+	}
+}
+
+static void win_touch_row(WINDOW *w, int r, int c0, int c1) {
+	if (c0 < w->firstch[r]) w->firstch[r] = c0;
+	if (c1 > w->lastch[r]) w->lastch[r] = c1;
+}
+
+static void win_set(WINDOW *w, int r, int c, int ch, int a) {
+	if (w->ch[r][c] != ch || w->at[r][c] != a) {
+		w->ch[r][c] = ch;
+		w->at[r][c] = a;
+		win_touch_row(w, r, c, c);
+	}
+}
+
+static void win_advance(WINDOW *w) {
+	w->curx++;
+	if (w->curx >= w->cols) {
+		w->cury++;
+		w->curx = 0;
+	}
+	if (w->cury >= w->rows) {
+		w->cury = w->rows-1;
+	}
+}
+
+static void win_addch(WINDOW *w, int ch) {
+	if (w->curx<0 || w->curx>=w->cols || w->cury<0 || w->cury>=w->rows)
+		return;
+
+	if (ch > 19) {
+		win_set(w, w->cury, w->curx, ch, w->attr);
+		win_advance(w);
+	}
+	else if (ch == 9) { /* expand tabs */
+		int ss = w->curx % 8;
+		if (ss==0) ss=8;
+		while (ss--) win_addch(w, ' ');
+	}
+	else {
+		win_advance(w);
+	}
+}
+
+static void win_blank(WINDOW *w, int r, int c0, int c1) {
+	int c;
+	for(c=c0; c<c1; c++)
+		win_set(w, r, c, ' ', 0);
+}
+
+/*
+ * Send the dirty runs of a window to Java in as few calls as possible,
+ * splitting a row into runs wherever the attribute changes.
+ */
+static void win_flush(WINDOW *w) {
+	int r, c, n, a, i;
+	int len = 0;
+
+	for(r=0; r<w->rows; r++) {
+		if (w->firstch[r] > w->lastch[r]) continue;
+
+		for(c=w->firstch[r]; c<=w->lastch[r]; c+=n) {
+			a = w->at[r][c];
+			for(n=1; c+n<=w->lastch[r] && w->at[r][c+n]==a; n++) ;
+
+			if (len + RUN_HDR + 2*n > RUN_BUF_SIZE) {
+				JAVA_CALL(NativeWrapper_wflush, w->w, run_buf_obj, len,
+						  w->cury, w->curx);
+				len = 0;
+			}
+
+			run_buf[len++] = r;
+			run_buf[len++] = c;
+			run_buf[len++] = (a >> 8) & 0xFF;
+			run_buf[len++] = a & 0xFF;
+			run_buf[len++] = n;
+			for(i=0; i<n; i++) {
+				run_buf[len++] = (w->ch[r][c+i] >> 8) & 0xFF;
+				run_buf[len++] = w->ch[r][c+i] & 0xFF;
+			}
+		}
+
+		w->firstch[r] = w->cols;
+		w->lastch[r] = -1;
+	}
+
+	LOGC("curses.win_flush %d %d",w->w,len);
+	JAVA_CALL(NativeWrapper_wflush, w->w, run_buf_obj, len, w->cury, w->curx);
+}
+
 int attrset(int attrs) {
 	return wattrset(stdscr, attrs);
 }
 int wattrset(WINDOW* w, int attrs) {
 	LOGC("curses.wattrset %d %d",w->w,attrs);
-	JAVA_CALL(NativeWrapper_wattrset, w->w, attrs);
+	w->attr = attrs;
 	return 0;
 }
 int attrget(int row, int col) {
@@ -73,8 +191,9 @@ int attrget(int row, int col) {
 }
 int wattrget(WINDOW* w,int row, int col) {
 	LOGC("curses.wattrget %d %d %d",w->w,row,col);
-	int attrs = JAVA_CALL_INT(NativeWrapper_wattrget, w->w, row, col);
-	return attrs;
+	if (col>-1 && col<w->cols && row>-1 && row<w->rows)
+		return w->at[row][col];
+	return -1;
 }
 
 int addch(const char a){
@@ -127,42 +246,36 @@ int addnwstr(int n, const wchar_t *s) {
 }
 
 int waddnstr(WINDOW* w, int n, const char *s) {
-	jbyteArray array = (*env)->NewByteArray(env, n);
-	if (array == NULL) angdroid_quit("Error: Out of memory");
-	(*env)->SetByteArrayRegion(env, array, 0, n, s);
+	int i;
 	LOGC("curses.waddnstr %d %d %c",w->w,n,s[0]);
-	JAVA_CALL(NativeWrapper_waddnstr, w->w, n, array);
-	(*env)->DeleteLocalRef(env, array);
+	for(i=0; i<n; i++)
+		win_addch(w, (unsigned char)s[i]);
 	return 0;
 }
 
-int waddnwstr(WINDOW* w, int n, const wchar_t *ws) {	
-	wchar_t* wbuf = malloc(sizeof(wchar_t)*(n+1));
-	memcpy(wbuf,ws,sizeof(wchar_t)*n);
-	wbuf[n]=0;
-
-	size_t len = wcstombs((char*)NULL, wbuf, (size_t)32000);
-	char* s = malloc(len+1);
-
-	wcstombs(s, wbuf, len+1);
-
-	free(wbuf);
-
-	waddnstr(w, n, s);
-
-	free(s);
+/*
+ * Wide characters go straight into the shadow as UTF-16 code units,
+ * which is what TermWindow stores, so there is nothing to convert or
+ * allocate.  Characters outside the BMP cannot be drawn and become '?'.
+ */
+int waddnwstr(WINDOW* w, int n, const wchar_t *ws) {
+	int i;
+	LOGC("curses.waddnwstr %d %d",w->w,n);
+	for(i=0; i<n; i++)
+		win_addch(w, ws[i] > 0xFFFF ? '?' : ws[i]);
 	return 0;
 }
 
 int move(int y, int x) {
-	LOGC("curses.move %d %d",y,x);
-	JAVA_CALL(NativeWrapper_wmove, 0, y, x);
-	return 0;
+	return wmove(stdscr, y, x);
 }
 
 int wmove(WINDOW* w, int y, int x) {
-	LOGC("curses.wmove %d %d %d",y,x);
-	JAVA_CALL(NativeWrapper_wmove, w->w, y, x);
+	LOGC("curses.wmove %d %d %d",w->w,y,x);
+	if (x>-1 && x<w->cols && y>-1 && y<w->rows) {
+		w->cury = y;
+		w->curx = x;
+	}
 	return 0;
 }
 
@@ -212,8 +325,11 @@ int hline(const char a, int n){
 	return 0;
 }
 int whline(WINDOW* w, const char a, int n){
-	LOGC("curses.whline %d %c %d",w-w,a,n);
-	JAVA_CALL(NativeWrapper_whline, w->w, a, n);
+	LOGC("curses.whline %d %c %d",w->w,a,n);
+	int i, x = w->curx+n;
+	if (x > w->cols) x = w->cols;
+	for(i=w->curx; i<x; i++)
+		win_addch(w, (unsigned char)a);
 	return 0;
 }
 
@@ -223,7 +339,7 @@ int clrtoeol(void){
 }
 int wclrtoeol(WINDOW *w){
 	LOGC("curses.wclrtoeol %d",w->w);
-	JAVA_CALL(NativeWrapper_wclrtoeol, w->w);
+	win_blank(w, w->cury, w->curx, w->cols);
 	return 0;
 }
 
@@ -233,14 +349,16 @@ int clear(void){
 }
 int wclear(WINDOW* w){
 	LOGC("curses.wclear %d",w->w);
-	JAVA_CALL(NativeWrapper_wclear, w->w);
+	int r;
+	for(r=0; r<w->rows; r++)
+		win_blank(w, r, 0, w->cols);
 	return 0;
 }
 
 int initscr() {
 	LOGC("curses.initscr");
 	JAVA_CALL(NativeWrapper_initscr);
-	stdscr->w = 0;
+	win_init(stdscr, 0, LINES, COLS, 0, 0);
 	clear();
 	touchwin(stdscr);
 	return 0;
@@ -280,7 +398,13 @@ int scrollok(WINDOW *w, int bf){
 }
 int scroll(WINDOW *w) {
 	LOGC("curses.scroll %d",w->w);
-	JAVA_CALL(NativeWrapper_scroll, w->w);
+	int r;
+	for(r=1; r<w->rows; r++) {
+		memcpy(w->ch[r-1], w->ch[r], w->cols*sizeof(w->ch[r][0]));
+		memcpy(w->at[r-1], w->at[r], w->cols*sizeof(w->at[r][0]));
+		win_touch_row(w, r-1, 0, w->cols-1);
+	}
+	win_blank(w, w->rows-1, 0, w->cols);
 	return 0;
 }
 
@@ -341,7 +465,9 @@ int clrtobot(void){
 }
 int wclrtobot(WINDOW* w){
 	LOGC("curses.wclrtobot %d",w->w);
-	JAVA_CALL(NativeWrapper_wclrtobot, w->w);
+	int r;
+	for(r=w->cury; r<w->rows; r++)
+		win_blank(w, r, w->curx, w->cols);
 	return 0;
 }
 
@@ -352,12 +478,12 @@ int beep() {
 
 int getcurx(WINDOW *w){
 	LOGC("curses.getcurx %d",w->w);
-	return JAVA_CALL_INT(NativeWrapper_getcurx, w->w);
+	return w->curx;
 }
 
 int getcury(WINDOW *w){
 	LOGC("curses.getcury %d",w->w);
-	return JAVA_CALL_INT(NativeWrapper_getcury, w->w);
+	return w->cury;
 }
 
 int curs_set(int v) {
@@ -373,7 +499,7 @@ WINDOW* newwin(int rows, int cols,
 	//hack
 	WINDOW* ret = stdscr;
 	if (k<WIN_MAX) {
-		_win[k].w = k;
+		win_init(&_win[k], k, rows, cols, begin_y, begin_x);
 		ret = &_win[k];
 	}
 	return ret;
@@ -386,18 +512,34 @@ int delwin(WINDOW* w) {
 
 int overwrite(const WINDOW *src, WINDOW *dst){
 	LOGC("curses.overwrite %d %d",src->w,dst->w);
-	JAVA_CALL(NativeWrapper_overwrite, src->w, dst->w);
+	int r, c;
+
+	/* blit the intersection, in screen coordinates */
+	int y0 = MAX(src->begy, dst->begy);
+	int x0 = MAX(src->begx, dst->begx);
+	int y1 = MIN(src->begy+src->rows, dst->begy+dst->rows);
+	int x1 = MIN(src->begx+src->cols, dst->begx+dst->cols);
+
+	for(r=y0; r<y1; r++) {
+		for(c=x0; c<x1; c++) {
+			win_set(dst, r-dst->begy, c-dst->begx,
+					src->ch[r-src->begy][c-src->begx],
+					src->at[r-src->begy][c-src->begx]);
+		}
+	}
 	return 0;
 }
 
 int touchwin(WINDOW *w){
 	LOGC("curses.touchwin %d",w->w);
+	win_flush(w);
 	JAVA_CALL(NativeWrapper_touchwin, w->w);
 	return 0;
 }
 
 int wrefresh(WINDOW *w){
 	LOGC("curses.wrefresh %d",w->w);
+	win_flush(w);
 	JAVA_CALL(NativeWrapper_wrefresh, w->w);
 	return 0;
 }
@@ -419,8 +561,8 @@ int mvinch(int r, int c) {
 }
 int mvwinch(WINDOW* w, int r, int c) {
 	LOGC("curses.mvwinch %d %d %d",w->w,r,c);
-	int ch = JAVA_CALL_INT(NativeWrapper_mvwinch, w->w, r, c);
-	return ch;
+	wmove(w, r, c);
+	return w->ch[w->cury][w->curx];
 }
 
 int flushinp() {
@@ -561,28 +703,16 @@ JNIEXPORT void JNICALL angdroid_gameStart
 	/* NativeWrapper Methods */
 	NativeWrapper_fatal = JAVA_METHOD("fatal", "(Ljava/lang/String;)V");	
 	NativeWrapper_warn = JAVA_METHOD("warn", "(Ljava/lang/String;)V");
-	NativeWrapper_waddnstr = JAVA_METHOD("waddnstr", "(II[B)V");
-	NativeWrapper_wattrset = JAVA_METHOD("wattrset", "(II)V");
-	NativeWrapper_wattrget = JAVA_METHOD("wattrget", "(III)I");
-	NativeWrapper_overwrite = JAVA_METHOD("overwrite", "(II)V");
+	NativeWrapper_wflush = JAVA_METHOD("wflush", "(ILjava/nio/ByteBuffer;III)V");
 	NativeWrapper_touchwin = JAVA_METHOD("touchwin", "(I)V");
-	NativeWrapper_whline = JAVA_METHOD("whline", "(IBI)V");
-	NativeWrapper_wclrtobot = JAVA_METHOD("wclrtobot", "(I)V");
-	NativeWrapper_wclrtoeol = JAVA_METHOD("wclrtoeol", "(I)V");
-	NativeWrapper_wclear = JAVA_METHOD("wclear", "(I)V");
 	NativeWrapper_noise = JAVA_METHOD("noise", "()V");
 	NativeWrapper_initscr = JAVA_METHOD("initscr", "()V");
 	NativeWrapper_wrefresh = JAVA_METHOD("wrefresh", "(I)V");
 	NativeWrapper_getch = JAVA_METHOD("getch", "(I)I");
-	NativeWrapper_getcury = JAVA_METHOD("getcury", "(I)I");
-	NativeWrapper_getcurx = JAVA_METHOD("getcurx", "(I)I");
 	NativeWrapper_init_color = JAVA_METHOD("init_color", "(II)V");
 	NativeWrapper_init_pair = JAVA_METHOD("init_pair", "(III)V");
 	NativeWrapper_newwin = JAVA_METHOD("newwin", "(IIII)I");
 	NativeWrapper_delwin = JAVA_METHOD("delwin", "(I)V");
-	NativeWrapper_scroll = JAVA_METHOD("scroll", "(I)V");
-	NativeWrapper_wmove = JAVA_METHOD("wmove", "(III)V");
-	NativeWrapper_mvwinch = JAVA_METHOD("mvwinch", "(III)I");
 	NativeWrapper_curs_set = JAVA_METHOD("curs_set", "(I)V");
 	NativeWrapper_flushinp = JAVA_METHOD("flushinp", "()V");
 // #ifdef ANGDROID_NIGHTLY
@@ -594,6 +724,10 @@ JNIEXPORT void JNICALL angdroid_gameStart
 	NativeWrapper_score_detail = JAVA_METHOD("score_detail", "([B[B)V");
 	NativeWrapper_score_submit = JAVA_METHOD("score_submit", "([B[B)V");
 
+	/* Shared buffer for win_flush() */
+	run_buf_obj = (*env)->NewGlobalRef(env,
+		(*env)->NewDirectByteBuffer(env, run_buf, sizeof(run_buf)));
+
 	// process argc/argv 
 	jstring argv0 = NULL;
 	int i;
@@ -611,6 +745,9 @@ JNIEXPORT void JNICALL angdroid_gameStart
 		angdroid_main();
 	else
 		; //longjmp to here
+
+	(*env)->DeleteGlobalRef(env, run_buf_obj);
+	run_buf_obj = NULL;
 }
 
 JNIEXPORT jint JNICALL angdroid_gameQueryInt
@@ -49,8 +49,21 @@
 #define LOGE(...) __android_log_print(ANDROID_LOG_ERROR  , "Angband", __VA_ARGS__) 
 #define LOG(...) __android_log_print(ANDROID_LOG_DEBUG  , "Angband", __VA_ARGS__)
 
+/*
+ * Each window keeps a native shadow of its cells, cursor and attribute.
+ * Writes only touch the shadow; the dirty span of each row (firstch and
+ * lastch, as in ncurses) is sent to Java in one batch on wrefresh().
+ */
 typedef struct WINDOW_s {
 	int w;
+	int rows, cols;
+	int begy, begx;
+	int cury, curx;
+	int attr;
+	unsigned short ch[LINES][COLS];
+	unsigned short at[LINES][COLS];
+	short firstch[LINES];
+	short lastch[LINES];
 } WINDOW;
 extern WINDOW* stdscr;
 
@@ -75,6 +88,7 @@ int addnwstr(int, const wchar_t *);
 int waddnstr(WINDOW*, int, const char *);
 int waddnwstr(WINDOW*, int, const wchar_t *);
 int move(int, int);
+int wmove(WINDOW*, int, int);
 int mvaddch(int, int, const char);
 int mvaddwch(int, int, const wchar_t);
 int mvwaddch(WINDOW *,int, int, const char);
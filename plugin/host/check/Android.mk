@@ -0,0 +1,16 @@
+LOCAL_PATH := $(call my-dir)
+
+include $(CLEAR_VARS)
+
+LOCAL_MODULE := curses-check
+LOCAL_CFLAGS := -std=c99
+
+LOCAL_C_INCLUDES := $(LOCAL_PATH)/../../curses
+
+LOCAL_LDLIBS := -llog
+
+LOCAL_SRC_FILES := \
+check.c \
+../../curses/curses.c
+
+include $(BUILD_SHARED_LIBRARY)
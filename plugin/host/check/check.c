@@ -0,0 +1,86 @@
+/*
+ * File: check.c
+ * Purpose: Self-check of curses.c under angdroid-host
+ *
+ * Draws a run of wide-character frames and requires that none of them
+ * creates a Java object, then scrolls a screen of two-byte characters
+ * and compares both the native shadow screen and the host screen with
+ * the expected rows.  Any failure goes through angdroid_quit(), which
+ * makes angdroid-host exit non-zero.
+ */
+
+#include <stdio.h>
+#include <wchar.h>
+#include "curses.h"
+
+#define CHECK_FRAMES 200
+
+/* provided by angdroid-host */
+extern long host_allocs(void);
+extern int host_inch(int y, int x);
+
+static char check_msg[160];
+
+static void check_frames(void) {
+	wchar_t line[COLS];
+	long before;
+	int f, r, c;
+
+	for(f=0; f<CHECK_FRAMES; f++) {
+		/* the first frame may set up buffers, the rest must not */
+		before = host_allocs();
+
+		for(r=0; r<LINES; r++) {
+			for(c=0; c<COLS; c++)
+				line[c] = (c + f) % 2 ? L'▒' : (wchar_t)('a' + (r + f) % 26);
+			attrset((r + f) % 16);
+			move(r, 0);
+			addnwstr(COLS, line);
+		}
+		refresh();
+
+		if (f && host_allocs() != before) {
+			sprintf(check_msg, "frame %d: %ld Java objects created",
+				f, host_allocs() - before);
+			angdroid_quit(check_msg);
+		}
+	}
+}
+
+static void check_scroll(void) {
+	int r, c, want;
+
+	for(r=0; r<LINES; r++)
+		for(c=0; c<COLS; c++)
+			mvaddwch(r, c, (wchar_t)(0x2500 + r * 3 + c % 3));
+	refresh();
+
+	scroll(stdscr);
+	refresh();
+
+	for(r=0; r<LINES; r++) {
+		for(c=0; c<COLS; c++) {
+			want = r < LINES-1 ? 0x2500 + (r+1) * 3 + c % 3 : ' ';
+			if (mvinch(r, c) != want || host_inch(r, c) != want) {
+				sprintf(check_msg, "scroll: %d,%d is %04x/%04x, want %04x",
+					r, c, mvinch(r, c), host_inch(r, c), want);
+				angdroid_quit(check_msg);
+			}
+		}
+	}
+}
+
+void angdroid_process_argv(int i, const char* argv) {
+}
+
+int queryInt(const char* argv) {
+	return 0;
+}
+
+void angdroid_main(void) {
+	initscr();
+	start_color();
+
+	check_frames();
+	check_scroll();
+}
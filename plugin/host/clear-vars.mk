@@ -0,0 +1,6 @@
+# Host stand-in for ndk-build's CLEAR_VARS
+LOCAL_MODULE :=
+LOCAL_CFLAGS :=
+LOCAL_C_INCLUDES :=
+LOCAL_LDLIBS :=
+LOCAL_SRC_FILES :=
@@ -0,0 +1,478 @@
+/*
+ * File: host.c
+ * Purpose: Headless stand-in for NativeWrapper on plain Linux
+ *
+ * Loads a plugin .so with dlopen() and runs angdroid_gameStart() with a
+ * fake JNIEnv.  The Java methods that curses.c looks up are implemented
+ * here against an in-memory screen, and keys are fed from a script, so
+ * the game runs at full CPU speed with no JVM or Android involved.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdarg.h>
+#include <unistd.h>
+#include <time.h>
+#include <dlfcn.h>
+#include <jni.h>
+#include "android/log.h"
+
+#define LINES 24
+#define COLS 80
+#define WIN_MAX 100
+
+/* Java objects handed to the plugin */
+enum { OBJ_WRAPPER, OBJ_CLASS, OBJ_STRING, OBJ_BYTES, OBJ_ARRAY, OBJ_BUFFER };
+
+typedef struct host_obj {
+	int kind;
+	jsize len;
+	void *data;
+} host_obj;
+
+#define OBJ(o) ((host_obj*)(o))
+
+static host_obj wrapper_obj = { OBJ_WRAPPER, 0, NULL };
+static host_obj wrapper_class = { OBJ_CLASS, 0, NULL };
+
+/* TermWindow stand-in */
+typedef struct host_win {
+	int used;
+	int rows, cols;
+	int begy, begx;
+	int cury, curx;
+	unsigned short ch[LINES][COLS];
+	int at[LINES][COLS];
+} host_win;
+
+static host_win wins[WIN_MAX];
+static host_win virtscr;
+static int win_next = 1;
+
+/* options */
+static const char *plugin_path = NULL;
+static const char *files_path = ".";
+static const char *savefile = "PLAYER";
+static const char *key_path = NULL;
+static double time_limit = 0;
+static long dump_every = 0;
+static int log_level = ANDROID_LOG_WARN;
+
+/* scripted keys */
+static unsigned char *keys = NULL;
+static long keys_len = 0;
+static long keys_pos = 0;
+
+/* counters */
+static long n_getch = 0;
+static long n_refresh = 0;
+static long n_flush = 0;
+static long n_flush_bytes = 0;
+static long n_alloc = 0;
+static long n_fatal = 0;
+static struct timespec start_time;
+
+static void *handle = NULL;
+static void (*plugin_quit)(const char*) = NULL;
+
+int __android_log_write(int prio, const char *tag, const char *text) {
+	if (prio >= log_level) fprintf(stderr, "%s: %s\n", tag, text);
+	return 0;
+}
+
+int __android_log_print(int prio, const char *tag, const char *fmt, ...) {
+	va_list ap;
+	if (prio < log_level) return 0;
+	fprintf(stderr, "%s: ", tag);
+	va_start(ap, fmt);
+	vfprintf(stderr, fmt, ap);
+	va_end(ap);
+	fputc('\n', stderr);
+	return 0;
+}
+
+static double elapsed(void) {
+	struct timespec now;
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return (now.tv_sec - start_time.tv_sec)
+		+ (now.tv_nsec - start_time.tv_nsec) / 1e9;
+}
+
+static void win_init(host_win *w, int rows, int cols, int begy, int begx) {
+	int r, c;
+	if (rows <= 0 || rows > LINES) rows = LINES;
+	if (cols <= 0 || cols > COLS) cols = COLS;
+	w->used = 1;
+	w->rows = rows;
+	w->cols = cols;
+	w->begy = begy;
+	w->begx = begx;
+	w->cury = w->curx = 0;
+	for(r=0; r<LINES; r++) {
+		for(c=0; c<COLS; c++) {
+			w->ch[r][c] = ' ';
+			w->at[r][c] = 0;
+		}
+	}
+}
+
+static host_win *get_win(int k) {
+	if (k < 0 || k >= WIN_MAX || !wins[k].used) return NULL;
+	return &wins[k];
+}
+
+static void put_utf8(unsigned c, FILE *f) {
+	if (c < 0x80) {
+		fputc(c, f);
+	} else if (c < 0x800) {
+		fputc(0xC0 | (c >> 6), f);
+		fputc(0x80 | (c & 0x3F), f);
+	} else {
+		fputc(0xE0 | (c >> 12), f);
+		fputc(0x80 | ((c >> 6) & 0x3F), f);
+		fputc(0x80 | (c & 0x3F), f);
+	}
+}
+
+static void dump_screen(FILE *f) {
+	int r, c;
+	fprintf(f, "--- refresh %ld ---\n", n_refresh);
+	for(r=0; r<virtscr.rows; r++) {
+		for(c=0; c<virtscr.cols; c++)
+			put_utf8(virtscr.ch[r][c], f);
+		fputc('\n', f);
+	}
+	fflush(f);
+}
+
+static void host_stop(void) {
+	if (plugin_quit) (*plugin_quit)(NULL);
+	exit(0);
+}
+
+/*** NativeWrapper methods ***/
+
+typedef jint (*host_method_fn)(va_list);
+
+typedef struct host_method {
+	const char *name;
+	host_method_fn fn;
+} host_method;
+
+static jint nw_ignore(va_list ap) {
+	return 0;
+}
+
+static jint nw_fatal(va_list ap) {
+	host_obj *s = OBJ(va_arg(ap, jobject));
+	n_fatal++;
+	fprintf(stderr, "fatal: %s\n", s ? (char*)s->data : "");
+	return 0;
+}
+
+static jint nw_warn(va_list ap) {
+	host_obj *s = OBJ(va_arg(ap, jobject));
+	fprintf(stderr, "warn: %s\n", s ? (char*)s->data : "");
+	return 0;
+}
+
+/* same record layout as win_flush() in curses.c */
+static jint nw_wflush(va_list ap) {
+	host_win *w = get_win(va_arg(ap, jint));
+	host_obj *buf = OBJ(va_arg(ap, jobject));
+	jint len = va_arg(ap, jint);
+	jint y = va_arg(ap, jint);
+	jint x = va_arg(ap, jint);
+	unsigned char *p = buf->data;
+	int i = 0, k;
+
+	n_flush++;
+	n_flush_bytes += len;
+	if (!w) return 0;
+
+	while (i < len) {
+		int r = p[i], c = p[i+1];
+		int a = (p[i+2] << 8) | p[i+3];
+		int n = p[i+4];
+		i += 5;
+		for(k=0; k<n && c+k<w->cols; k++) {
+			w->ch[r][c+k] = (p[i+2*k] << 8) | p[i+2*k+1];
+			w->at[r][c+k] = a;
+		}
+		i += 2*n;
+	}
+	w->cury = y;
+	w->curx = x;
+	return 0;
+}
+
+static jint nw_wrefresh(va_list ap) {
+	host_win *w = get_win(va_arg(ap, jint));
+	int r, c;
+
+	n_refresh++;
+	if (!w) return 0;
+
+	for(r=0; r<w->rows && w->begy+r<LINES; r++) {
+		for(c=0; c<w->cols && w->begx+c<COLS; c++) {
+			virtscr.ch[w->begy+r][w->begx+c] = w->ch[r][c];
+			virtscr.at[w->begy+r][w->begx+c] = w->at[r][c];
+		}
+	}
+	virtscr.cury = w->begy + w->cury;
+	virtscr.curx = w->begx + w->curx;
+
+	if (dump_every && n_refresh % dump_every == 0) dump_screen(stdout);
+	return 0;
+}
+
+static jint nw_getch(va_list ap) {
+	jint v = va_arg(ap, jint);
+
+	n_getch++;
+	if (time_limit > 0 && elapsed() > time_limit) host_stop();
+
+	if (keys_pos < keys_len) return keys[keys_pos++];
+
+	/* out of keys: let a waiting game end, a polling game keep going */
+	if (v) host_stop();
+	return 0;
+}
+
+static jint nw_newwin(va_list ap) {
+	jint rows = va_arg(ap, jint);
+	jint cols = va_arg(ap, jint);
+	jint begy = va_arg(ap, jint);
+	jint begx = va_arg(ap, jint);
+	int k = win_next++;
+	if (k < WIN_MAX) win_init(&wins[k], rows, cols, begy, begx);
+	return k;
+}
+
+static jint nw_delwin(va_list ap) {
+	host_win *w = get_win(va_arg(ap, jint));
+	if (w) w->used = 0;
+	return 0;
+}
+
+static const host_method methods[] = {
+	{ "fatal", nw_fatal },
+	{ "warn", nw_warn },
+	{ "wflush", nw_wflush },
+	{ "wrefresh", nw_wrefresh },
+	{ "getch", nw_getch },
+	{ "newwin", nw_newwin },
+	{ "delwin", nw_delwin },
+	{ NULL, nw_ignore }	/* everything else is a no-op */
+};
+
+/*** JNIEnv ***/
+
+static jclass JNICALL env_GetObjectClass(JNIEnv *env, jobject obj) {
+	return (jclass)&wrapper_class;
+}
+
+static jmethodID JNICALL env_GetMethodID(JNIEnv *env, jclass clazz,
+										 const char *name, const char *sig) {
+	const host_method *m;
+	for(m=methods; m->name; m++)
+		if (strcmp(m->name, name) == 0) break;
+	return (jmethodID)m;
+}
+
+static void JNICALL env_CallVoidMethod(JNIEnv *env, jobject obj,
+									   jmethodID id, ...) {
+	va_list ap;
+	va_start(ap, id);
+	((const host_method*)id)->fn(ap);
+	va_end(ap);
+}
+
+static jint JNICALL env_CallIntMethod(JNIEnv *env, jobject obj,
+									  jmethodID id, ...) {
+	va_list ap;
+	jint ret;
+	va_start(ap, id);
+	ret = ((const host_method*)id)->fn(ap);
+	va_end(ap);
+	return ret;
+}
+
+static host_obj *new_obj(int kind, jsize len, void *data) {
+	host_obj *o = malloc(sizeof(host_obj));
+	n_alloc++;
+	o->kind = kind;
+	o->len = len;
+	o->data = data;
+	return o;
+}
+
+static jbyteArray JNICALL env_NewByteArray(JNIEnv *env, jsize len) {
+	return (jbyteArray)new_obj(OBJ_BYTES, len, calloc(len ? len : 1, 1));
+}
+
+static void JNICALL env_SetByteArrayRegion(JNIEnv *env, jbyteArray array,
+										   jsize start, jsize len,
+										   const jbyte *buf) {
+	memcpy((jbyte*)OBJ(array)->data + start, buf, len);
+}
+
+static void JNICALL env_GetByteArrayRegion(JNIEnv *env, jbyteArray array,
+										   jsize start, jsize len, jbyte *buf) {
+	memcpy(buf, (jbyte*)OBJ(array)->data + start, len);
+}
+
+static jstring JNICALL env_NewStringUTF(JNIEnv *env, const char *s) {
+	return (jstring)new_obj(OBJ_STRING, strlen(s), strdup(s));
+}
+
+static jobject JNICALL env_NewDirectByteBuffer(JNIEnv *env, void *addr,
+											   jlong cap) {
+	return (jobject)new_obj(OBJ_BUFFER, (jsize)cap, addr);
+}
+
+static void JNICALL env_DeleteLocalRef(JNIEnv *env, jobject obj) {
+	host_obj *o = OBJ(obj);
+	if (!o || o == &wrapper_obj || o == &wrapper_class) return;
+	if (o->kind != OBJ_BUFFER && o->kind != OBJ_ARRAY) free(o->data);
+	free(o);
+}
+
+static jobject JNICALL env_NewGlobalRef(JNIEnv *env, jobject obj) {
+	return obj;
+}
+
+static void JNICALL env_DeleteGlobalRef(JNIEnv *env, jobject obj) {
+	env_DeleteLocalRef(env, obj);
+}
+
+static jobject JNICALL env_GetObjectArrayElement(JNIEnv *env,
+												 jobjectArray array, jsize i) {
+	return ((jobject*)OBJ(array)->data)[i];
+}
+
+static const char * JNICALL env_GetStringUTFChars(JNIEnv *env, jstring s,
+												  jboolean *copy) {
+	if (copy) *copy = JNI_FALSE;
+	return OBJ(s)->data;
+}
+
+static void JNICALL env_ReleaseStringUTFChars(JNIEnv *env, jstring s,
+											  const char *chars) {
+}
+
+static const struct JNINativeInterface_ host_env_fns = {
+	.GetObjectClass = env_GetObjectClass,
+	.GetMethodID = env_GetMethodID,
+	.CallVoidMethod = env_CallVoidMethod,
+	.CallIntMethod = env_CallIntMethod,
+	.NewByteArray = env_NewByteArray,
+	.SetByteArrayRegion = env_SetByteArrayRegion,
+	.GetByteArrayRegion = env_GetByteArrayRegion,
+	.NewStringUTF = env_NewStringUTF,
+	.NewDirectByteBuffer = env_NewDirectByteBuffer,
+	.DeleteLocalRef = env_DeleteLocalRef,
+	.NewGlobalRef = env_NewGlobalRef,
+	.DeleteGlobalRef = env_DeleteGlobalRef,
+	.GetObjectArrayElement = env_GetObjectArrayElement,
+	.GetStringUTFChars = env_GetStringUTFChars,
+	.ReleaseStringUTFChars = env_ReleaseStringUTFChars,
+};
+
+static JNIEnv host_env = &host_env_fns;
+
+/*** Driver ***/
+
+/* Java objects created so far, for plugins checking their per-frame cost */
+long host_allocs(void) {
+	return n_alloc;
+}
+
+/* character on the host screen, as Java would draw it */
+int host_inch(int y, int x) {
+	return virtscr.ch[y][x];
+}
+
+static void load_keys(const char *path) {
+	FILE *f = fopen(path, "rb");
+	long n;
+	if (!f) {
+		perror(path);
+		exit(1);
+	}
+	fseek(f, 0, SEEK_END);
+	keys_len = ftell(f);
+	fseek(f, 0, SEEK_SET);
+	keys = malloc(keys_len ? keys_len : 1);
+	n = fread(keys, 1, keys_len, f);
+	keys_len = n;
+	fclose(f);
+}
+
+static void usage(const char *argv0) {
+	fprintf(stderr,
+		"usage: %s -p plugin.so [-f files_path] [-s savefile] [-k keyfile]\n"
+		"          [-t seconds] [-d every_n_refreshes] [-v]\n", argv0);
+	exit(1);
+}
+
+int main(int argc, char *argv[]) {
+	void (*gameStart)(JNIEnv*, jobject, jint, jobjectArray);
+	jobject args[2];
+	host_obj argv_obj;
+	double secs;
+	int opt;
+
+	while ((opt = getopt(argc, argv, "p:f:s:k:t:d:v")) != -1) {
+		switch (opt) {
+			case 'p': plugin_path = optarg; break;
+			case 'f': files_path = optarg; break;
+			case 's': savefile = optarg; break;
+			case 'k': key_path = optarg; break;
+			case 't': time_limit = atof(optarg); break;
+			case 'd': dump_every = atol(optarg); break;
+			case 'v': log_level = ANDROID_LOG_VERBOSE; break;
+			default: usage(argv[0]);
+		}
+	}
+	if (!plugin_path) usage(argv[0]);
+	if (key_path) load_keys(key_path);
+
+	/* StateManager.endWin(): stdscr is handle 0 */
+	win_init(&wins[0], 0, 0, 0, 0);
+	win_init(&virtscr, 0, 0, 0, 0);
+
+	handle = dlopen(plugin_path, RTLD_LOCAL | RTLD_NOW);
+	if (!handle) {
+		fprintf(stderr, "dlopen failed: %s\n", dlerror());
+		return 1;
+	}
+	gameStart = dlsym(handle, "angdroid_gameStart");
+	plugin_quit = dlsym(handle, "angdroid_quit");
+	if (!gameStart || !plugin_quit) {
+		fprintf(stderr, "dlsym failed: %s\n", dlerror());
+		return 1;
+	}
+
+	args[0] = env_NewStringUTF(&host_env, files_path);
+	args[1] = env_NewStringUTF(&host_env, savefile);
+	argv_obj.kind = OBJ_ARRAY;
+	argv_obj.len = 2;
+	argv_obj.data = args;
+
+	clock_gettime(CLOCK_MONOTONIC, &start_time);
+	gameStart(&host_env, (jobject)&wrapper_obj, 2, (jobjectArray)&argv_obj);
+	secs = elapsed();
+
+	if (dump_every) dump_screen(stdout);
+	fprintf(stderr,
+		"%.3f s, %ld getch, %ld refresh (%.1f/s), %ld flush, %ld bytes, "
+		"%ld allocs (%.2f/refresh)\n",
+		secs, n_getch, n_refresh, secs > 0 ? n_refresh / secs : 0.0,
+		n_flush, n_flush_bytes, n_alloc,
+		n_refresh ? (double)n_alloc / n_refresh : 0.0);
+
+	dlclose(handle);
+	return n_fatal ? 1 : 0;
+}
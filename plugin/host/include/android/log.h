@@ -0,0 +1,23 @@
+/*
+ * Host stand-in for the NDK logging API.  The functions are exported by
+ * angdroid-host, which writes the messages to stderr.
+ */
+#ifndef ANGDROID_HOST_LOG_H
+#define ANGDROID_HOST_LOG_H
+
+typedef enum android_LogPriority {
+	ANDROID_LOG_UNKNOWN = 0,
+	ANDROID_LOG_DEFAULT,
+	ANDROID_LOG_VERBOSE,
+	ANDROID_LOG_DEBUG,
+	ANDROID_LOG_INFO,
+	ANDROID_LOG_WARN,
+	ANDROID_LOG_ERROR,
+	ANDROID_LOG_FATAL,
+	ANDROID_LOG_SILENT
+} android_LogPriority;
+
+int __android_log_write(int prio, const char *tag, const char *text);
+int __android_log_print(int prio, const char *tag, const char *fmt, ...);
+
+#endif /* ANGDROID_HOST_LOG_H */
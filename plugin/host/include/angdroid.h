@@ -0,0 +1,5 @@
+/*
+ * Host stand-in for the javah-generated angdroid.h.  The plugins only
+ * need jni.h from it; the Java_* entry points live in the loader.
+ */
+#include <jni.h>
@@ -0,0 +1,18 @@
+# Host stand-in for ndk-build's BUILD_SHARED_LIBRARY.  Objects are kept
+# under out/<module>/<absolute source path>; -llog is provided by
+# angdroid-host itself.
+HOST_MODULE := $(LOCAL_MODULE)
+HOST_SRCS := $(abspath $(addprefix $(LOCAL_PATH)/,$(LOCAL_SRC_FILES)))
+HOST_OBJS := $(patsubst %.c,$(OUT)/$(HOST_MODULE)%.o,$(HOST_SRCS))
+
+$(HOST_OBJS): HOST_CFLAGS := $(LOCAL_CFLAGS) $(addprefix -I,$(LOCAL_C_INCLUDES))
+
+$(OUT)/$(HOST_MODULE)/%.o: /%.c
+	@mkdir -p $(dir $@)
+	$(CC) $(CFLAGS) -fPIC $(HOST_INCLUDES) $(HOST_CFLAGS) -c $< -o $@
+
+$(OUT)/lib$(HOST_MODULE).so: HOST_LDLIBS := $(filter-out -llog,$(LOCAL_LDLIBS))
+$(OUT)/lib$(HOST_MODULE).so: $(HOST_OBJS)
+	$(CC) -shared -o $@ $^ $(HOST_LDLIBS) -lm
+
+HOST_LIBS += $(OUT)/lib$(HOST_MODULE).so
@@ -1,5 +1,6 @@
 package org.angdroid.angband;
 
+import java.nio.ByteBuffer;
 import java.util.Formatter;
 import android.util.Log;
 	
@@ -191,20 +192,14 @@ public class NativeWrapper {
 		p.isUgly = false;
 	}
 
-	public void waddnstr(final int w, final int n, final byte[] cp) {
+	public void wflush(final int w, final ByteBuffer runs, final int len,
+					   final int y, final int x) {
 		synchronized (display_lock) {
 			TermWindow t = state.getWin(w);
-			if (t != null) t.addnstr(n, cp);
-		}
-	}
-
-	public int mvwinch(final int w, final int r, final int c) {
-		synchronized (display_lock) {
-			TermWindow t = state.getWin(w);
-			if (t != null) 
-				return t.mvinch(r, c);
-			else
-				return 0;
+			if (t != null) {
+				t.addruns(runs, len);
+				t.move(y, x);
+			}
 		}
 	}
 
@@ -220,71 +215,12 @@ public class NativeWrapper {
 		}
 	}
 
-	public void scroll(final int w) {
-		synchronized (display_lock) {
-			TermWindow t = state.getWin(w);
-			if (t != null) t.scroll();
-		}
-	}
-
-	public int wattrget(final int w, final int r, final int c) {
-		synchronized (display_lock) {
-			TermWindow t = state.getWin(w);
-			if (t != null) 
-				return t.attrget(r, c);
-			else 
-				return 0;
-		}
-	}
-
-	public void wattrset(final int w, final int a) {
-		synchronized (display_lock) {
-			TermWindow t = state.getWin(w);
-			if (t != null) t.attrset(a);
-		}
-	}
-
-	public void whline(final int w, final byte c, final int n) {
-		synchronized (display_lock) {
-			TermWindow t = state.getWin(w);
-			if (t != null) t.hline((char)c, n);
-		}
-	}
-
-	public void wclear(final int w) {
-		synchronized (display_lock) {
-			TermWindow t = state.getWin(w);
-			if (t != null) t.clear();
-		}
-	}
-
-	public void wclrtoeol(final int w) {
-		synchronized (display_lock) {
-			TermWindow t = state.getWin(w);
-			if (t != null) t.clrtoeol();
-		}
-	}
-
-	public void wclrtobot(final int w) {
-		synchronized (display_lock) {
-			TermWindow t = state.getWin(w);
-			if (t != null) t.clrtobot();
-		}
-	}
-
 	public void noise() {
 		synchronized (display_lock) {
 			if (term != null) term.noise();
 		}
 	}
 
-	public void wmove(int w, final int y, final int x) {
-		synchronized (display_lock) {
-			TermWindow t = state.getWin(w);
-			if (t != null) t.move(y,x);
-		}		
-	}
-
 	public void curs_set(final int v) {
 		if (v == 1) {
 			state.stdscr.cursor_visible = true;
@@ -319,30 +255,6 @@ public class NativeWrapper {
 		}		
 	}
 
-	public void overwrite (final int wsrc, final int wdst) {
-		synchronized (display_lock) {
-			TermWindow td = state.getWin(wdst);
-			TermWindow ts = state.getWin(wsrc);
-			if (td != null && ts != null) td.overwrite(ts);
-		}		
-	}
-
-	int getcury(final int w) {
-		TermWindow t = state.getWin(w);
-		if (t != null) 
-			return t.getcury();
-		else
-			return 0;
-	}
-
-	int getcurx(final int w) {
-		TermWindow t = state.getWin(w);
-		if (t != null) 
-			return t.getcurx();
-		else
-			return 0;
-	}
-
     public int wctomb(byte[] pmb, byte character) {
 	    byte[] ba = new byte[1];
 	    ba[0] = character;
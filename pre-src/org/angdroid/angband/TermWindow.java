@@ -1,6 +1,7 @@
 package org.angdroid.angband;
 
 import android.util.Log;
+import java.nio.ByteBuffer;
 import java.util.Formatter;
 import java.util.Map;
 import java.util.HashMap;
@@ -75,59 +76,10 @@ public class TermWindow {
 		return p;
 	}
 
-	public void clearPoint(int row, int col) {
-		if (col>-1 && col<cols 
-			&& row>-1 && row<rows) {
-			TermPoint p = buffer[row][col];
-			newPoint(p);
-		}
-		else {
-			Log.d("Angband","TermWindow.clearPoint - point out of bounds: "+col+","+row);
-		}
-	}
-
 	protected void attrset(int a) {
 		cur_color = a;
 	}
 
-	public void clear() {
-		//Log.d("Angband","TermWindow.clear start "+rows+","+cols);
-		for(int r=0;r<rows;r++) {
-			for(int c=0;c<cols;c++) {
-				//Log.d("Angband","TermWindow.clear clearPoint "+r+","+c);
-				TermPoint p = buffer[r][c];
-				newPoint(p);
-			}
-		}
-		//Log.d("Angband","TermWindow.clear end");
-	}
-
-	public void clrtoeol() {
-		//Log.d("Angband","TermWindow.clrtoeol ("+row+","+col+")");
-		for(int c=col;c<cols;c++) {
-			TermPoint p = buffer[row][c];
-			newPoint(p);
-		}
-	}
-
-	public void clrtobot() {
-		//Log.d("Angband","TermWindow.clrtobot ("+row+","+col+")");
-		for(int r=row;r<rows;r++) {
-			for(int c=col;c<cols;c++) {
-				TermPoint p = buffer[r][c];
-				newPoint(p);
-			}
-		}
-	}
-
-	public void hline(char c, int n) {
-		//Log.d("Angband","TermWindow.hline ("+row+","+col+") "+n);
-		int x = Math.min(cols,n+col);
-		for(int i=col;i<x;i++) {
-			addch(c);
-		}
-	}
-
 	public void move(int row, int col) {
 		if (col>-1 && col<cols && row>-1 & row<rows) {
 			this.col = col;
@@ -135,30 +87,6 @@ public class TermWindow {
 		}
 	}
 
-	public int inch() {
-		return buffer[this.row][this.col].Char;
-	}
-
-	public int mvinch(int row, int col) {
-		move(row,col);
-		return inch();
-	}
-
-	public int attrget(int row, int col) {
-		if (col>-1 && col<cols && row>-1 & row<rows) {
-			return buffer[row][col].Color;
-		}
-		return -1;
-	}
-
-	public int getcury() {
-		return row;
-	}
-
-	public int getcurx() {
-		return col;
-	}
-
 	public void overwrite(TermWindow wsrc) {
 
 		int sx0 = wsrc.begin_x;
@@ -201,26 +129,28 @@ public class TermWindow {
 		}
 	}
 
-	public void addnstr(int n, byte[] cp) {
-		/*
-		String foo = new String(cp);
-		Log.d("Angband","addnstr ("+row+","+col+") ["+foo+"]");
-		*/
+	/* replay runs packed by win_flush() in curses.c:
+	   row, col, attr (2 bytes), n, then n UTF-16 chars */
+	public void addruns(ByteBuffer runs, int len) {
+		int i = 0;
+		while (i < len) {
+			int r = runs.get(i) & 0xFF;
+			int c = runs.get(i+1) & 0xFF;
+			int a = runs.getShort(i+2) & 0xFFFF;
+			int n = runs.get(i+4) & 0xFF;
+			i += 5;
 
-		String str;
-		try {
-			str = new String(cp, "ISO-8859-1");
-		} catch(java.io.UnsupportedEncodingException e) {
-			str = "";
-		}
-		
-		for (int i = 0; i < n; i++) {
-		    addch(str.charAt(i));
+			move(r, c);
+			attrset(a);
+			for (int k = 0; k < n; k++) {
+				addch(runs.getChar(i+2*k));
+			}
+			i += 2*n;
 		}
 	}
 
 	public void addch(char c) {
-		
+
 		/*
 		Formatter fmt = new Formatter();
 		fmt.format("color: %x", cur_color);
@@ -262,17 +192,4 @@ public class TermWindow {
 			row = rows-1;
 		}
 	}
-
-	public void mvaddch(int row, int col, char c) {
-		move(row, col);
-		addch(c);
-	}
-
-	public void scroll() {
-		for(int r=1;r<rows;r++) {
-			for(int c=0;c<cols;c++) {
-				buffer[r-1][c] = buffer[r][c];
-			}
-		}
-	}
 }
\ No newline at end of file